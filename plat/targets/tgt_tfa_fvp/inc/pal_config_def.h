@@ -93,9 +93,15 @@
  * |              |      |    Heap     |
  * |              |      |   Memory    |
  * |              |      |    (49MB)   |
+ * |              |      |             |
+ * |              |      |             |
+ * |              |      |             |
  * +--------------+      +-------------+
  *
  * 2MB for Image loading and 50MB as Free NS Space.
+ * Top 16MB of the heap is preferred by 2MB aligned allocations, the rest of the
+ * heap is used by other allocations first. Each part is used by the other
+ * allocations once it is exhausted.
  */
 
 #define PLATFORM_NORMAL_WORLD_IMAGE_SIZE  0x200000
@@ -105,6 +111,7 @@
 #define PLATFORM_SHARED_REGION_SIZE       0x100000
 #define PLATFORM_HEAP_REGION_SIZE         (PLATFORM_MEMORY_POOL_SIZE \
                                              - PLATFORM_SHARED_REGION_SIZE)
+#define PLATFORM_HEAP_BLOCK_REGION_SIZE   (16 * 0x100000)
 
 /*
  * Run-time address of the ACS Non-secure image. It has to match
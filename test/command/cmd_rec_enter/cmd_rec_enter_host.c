@@ -64,6 +64,9 @@ static uint64_t g_rd_new_prep_sequence(uint16_t vmid)
     }
     realm_test[vmid].rd = realm_init.rd;
     realm_test[vmid].rtt_l0_addr = realm_init.rtt_l0_addr;
+    realm_test[vmid].rec_slots = realm_init.rec_slots;
+    realm_test[vmid].rec = realm_init.rec;
+    realm_test[vmid].run = realm_init.run;
     return realm_init.rd;
 }
 
@@ -29,6 +29,12 @@ uint32_t val_host_realm_create_common(val_host_realm_ts *realm)
     val_host_realm_params_ts *params;
     uint64_t ret, i, j;
 
+    if (val_host_realm_storage_alloc(realm))
+    {
+        val_host_realm_storage_free(realm);
+        return VAL_ERROR;
+    }
+
     /* Allocate and delegate RD */
     realm->rd = (uint64_t)val_host_mem_alloc(PAGE_SIZE, PAGE_SIZE);
     if (!realm->rd)
@@ -88,16 +94,14 @@ uint32_t val_host_realm_create_common(val_host_realm_ts *realm)
     }
 
 
-    /* Allocate memory for params */
-    params = val_host_mem_alloc(PAGE_SIZE, PAGE_SIZE);
+    /* Get zeroed scratch page for params */
+    params = val_host_scratch_page_get();
     if (params == NULL)
     {
         LOG(ERROR, "Failed to allocate memory for params\n");
         goto undelegate_rtt;
     }
 
-    val_memset(params, 0, PAGE_SIZE);
-
     /* Populate params */
     params->rtt_base = realm->rtt_l0_addr;
     params->hash_algo = realm->hash_algo;
@@ -129,12 +133,11 @@ uint32_t val_host_realm_create_common(val_host_realm_ts *realm)
         goto free_params;
     }
 
-    /* Free params */
-    val_host_mem_free(params);
+    val_host_realm_params_reset(params);
     return VAL_SUCCESS;
 
 free_params:
-    val_host_mem_free(params);
+    val_host_realm_params_reset(params);
 
 undelegate_rtt:
     ret = val_host_rmi_granule_undelegate(realm->rtt_l0_addr);
@@ -154,6 +157,7 @@ undelegate_rd:
     }
 free_rd:
      val_host_mem_free((void *)realm->rd);
+    val_host_realm_storage_free(realm);
 
     return VAL_ERROR;
 }
@@ -163,13 +167,7 @@ uint32_t val_host_rec_create_common(val_host_realm_ts *realm, val_host_rec_param
     val_host_rec_params_ts   *rec_params;
     val_host_rec_create_flags_ts rec_create_flags;
 
-    uint64_t ret, i, mpidr = 0x0, aux_count, j;
-
-    if (realm->rec_count > VAL_MAX_REC_COUNT)
-    {
-        LOG(ERROR, "max supported recs are VAL_MAX_REC_COUNT\n");
-        return VAL_ERROR;
-    }
+    uint64_t ret, i, aux_count, j;
 
     /* Get aux granules count */
     ret = val_host_rmi_rec_aux_count(realm->rd, &aux_count);
@@ -186,31 +184,28 @@ uint32_t val_host_rec_create_common(val_host_realm_ts *realm, val_host_rec_param
 
     }
 
-    /* Allocate memory for rec_params */
-    rec_params = val_host_mem_alloc(PAGE_SIZE, PAGE_SIZE);
+    if (val_host_realm_rec_storage_reserve(realm, realm->rec_count, aux_count))
+        return VAL_ERROR;
+
+    /* Get zeroed scratch page for rec_params */
+    rec_params = val_host_scratch_page_get();
     if (rec_params == NULL)
     {
         LOG(ERROR, "Failed to allocate memory for rec_params\n");
         return VAL_ERROR;
     }
-    val_memset(rec_params, 0x0, PAGE_SIZE);
 
-    /* Populate rec_params */
+    /* Populate rec_params, gprs are left zero */
     rec_params->num_aux = aux_count;
     realm->aux_count = aux_count;
 
-    for (i = 0; i < (sizeof(rec_params->gprs)/sizeof(rec_params->gprs[0])); i++)
-    {
-        rec_params->gprs[i] = 0x0;
-    }
-
     rec_params->pc = params->pc;
     rec_create_flags.runnable = RMI_RUNNABLE;
     val_memcpy(&rec_params->flags, &rec_create_flags, sizeof(rec_create_flags));
 
-    for (i = 0; i < realm->rec_count; i++, mpidr++)
+    for (i = 0; i < realm->rec_count; i++)
     {
-        rec_params->mpidr = mpidr;
+        rec_params->mpidr = VAL_HOST_REC_MPIDR(i);
         /* Allocate memory for run object */
         realm->run[i] = (uint64_t)val_host_mem_alloc(PAGE_SIZE, PAGE_SIZE);
         if (!realm->run[i])
@@ -263,8 +258,7 @@ uint32_t val_host_rec_create_common(val_host_realm_ts *realm, val_host_rec_param
         }
     }
 
-    /* Free rec_params */
-    val_host_mem_free(rec_params);
+    val_host_rec_params_reset(rec_params);
     return VAL_SUCCESS;
 
 free_rec_params:
@@ -296,7 +290,7 @@ free_rec_params:
         }
     }
 
-    val_host_mem_free(rec_params);
+    val_host_rec_params_reset(rec_params);
     return VAL_ERROR;
 }
 
@@ -186,6 +186,20 @@ DECLARE_TEST_FN(mec_private_shared);
 DECLARE_TEST_FN(lfa_test);
 /* LFA testcase declaration ends here */
 
+/* Perf testcase declaration starts here */
+DECLARE_TEST_FN(perf_heap_reclaim);
+DECLARE_TEST_FN(perf_granule_lookup);
+DECLARE_TEST_FN(perf_teardown_rtt_walk);
+DECLARE_TEST_FN(perf_postamble_parallel);
+DECLARE_TEST_FN(perf_map_l2_blocks);
+DECLARE_TEST_FN(perf_populate_parallel);
+DECLARE_TEST_FN(perf_journal_replay);
+DECLARE_TEST_FN(perf_rmi_granule);
+DECLARE_TEST_FN(perf_rmi_realm);
+DECLARE_TEST_FN(perf_rmi_rtt);
+DECLARE_TEST_FN(perf_rmi_data);
+/* Perf testcase declaration ends here */
+
 
 #else /* TEST_FUNC_DATABASE */
 /* Add test funcs to the respective host/realm/secure test_list array */
@@ -685,4 +699,40 @@ DECLARE_TEST_FN(lfa_test);
     #endif /* #if (defined(d_all) || defined(d_lfa)) */
 #endif /* #if defined(RMM_V_1_1) */
 
+#if (defined(d_all) || defined(d_perf))
+    #if (defined(TEST_COMBINE) || defined(d_perf_heap_reclaim))
+    HOST_TEST(perf, perf, perf_heap_reclaim),
+    #endif
+    #if (defined(TEST_COMBINE) || defined(d_perf_granule_lookup))
+    HOST_TEST(perf, perf, perf_granule_lookup),
+    #endif
+    #if (defined(TEST_COMBINE) || defined(d_perf_teardown_rtt_walk))
+    HOST_TEST(perf, perf, perf_teardown_rtt_walk),
+    #endif
+    #if (defined(TEST_COMBINE) || defined(d_perf_postamble_parallel))
+    HOST_TEST(perf, perf, perf_postamble_parallel),
+    #endif
+    #if (defined(TEST_COMBINE) || defined(d_perf_map_l2_blocks))
+    HOST_TEST(perf, perf, perf_map_l2_blocks),
+    #endif
+    #if (defined(TEST_COMBINE) || defined(d_perf_populate_parallel))
+    HOST_TEST(perf, perf, perf_populate_parallel),
+    #endif
+    #if (defined(TEST_COMBINE) || defined(d_perf_journal_replay))
+    HOST_TEST(perf, perf, perf_journal_replay),
+    #endif
+    #if (defined(TEST_COMBINE) || defined(d_perf_rmi_granule))
+    HOST_TEST(perf, perf, perf_rmi_granule),
+    #endif
+    #if (defined(TEST_COMBINE) || defined(d_perf_rmi_realm))
+    HOST_TEST(perf, perf, perf_rmi_realm),
+    #endif
+    #if (defined(TEST_COMBINE) || defined(d_perf_rmi_rtt))
+    HOST_TEST(perf, perf, perf_rmi_rtt),
+    #endif
+    #if (defined(TEST_COMBINE) || defined(d_perf_rmi_data))
+    HOST_TEST(perf, perf, perf_rmi_data),
+    #endif
+#endif /* #if (defined(d_all) || defined(d_perf)) */
+
 #endif /* TEST_FUNC_DATABASE */
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include "perf_common_host.h"
+#include "command_common_host.h"
+#include "val_timer.h"
+
+/**
+ * @brief Start a new set of samples
+ * @param samples - Samples of an RMI command
+ * @param name - Name printed in the report
+ * @return void
+ **/
+void perf_rmi_samples_init(perf_rmi_samples_ts *samples, const char *name)
+{
+    samples->name = name;
+    samples->count = 0;
+}
+
+/**
+ * @brief Read the counter before the timed call
+ * @param samples - Samples of an RMI command
+ * @return void
+ **/
+void perf_rmi_sample_start(perf_rmi_samples_ts *samples)
+{
+    samples->start = val_read_cntpct_el0();
+}
+
+/**
+ * @brief Store the duration of the timed call, extra calls are dropped
+ * @param samples - Samples of an RMI command
+ * @return void
+ **/
+void perf_rmi_sample_end(perf_rmi_samples_ts *samples)
+{
+    uint64_t end = val_read_cntpct_el0();
+
+    if (samples->count < PERF_RMI_SAMPLES)
+        samples->ticks[samples->count++] = end - samples->start;
+}
+
+/**
+ * @brief Sort the samples and print their min, median, p99 and max in ns
+ * @param samples - Samples of an RMI command
+ * @return void
+ **/
+void perf_rmi_report(perf_rmi_samples_ts *samples)
+{
+    uint64_t freq = val_read_cntfrq_el0();
+    uint64_t *ticks = samples->ticks;
+    uint64_t key;
+    uint32_t i, j, count = samples->count;
+
+    if (count == 0)
+        return;
+
+    for (i = 1; i < count; i++)
+    {
+        key = ticks[i];
+        for (j = i; j > 0 && ticks[j - 1] > key; j--)
+            ticks[j] = ticks[j - 1];
+        ticks[j] = key;
+    }
+
+    LOG(ALWAYS, "\t%s : min %d ns, median %d ns", samples->name,
+                (ticks[0] * 1000000000) / freq, (ticks[count / 2] * 1000000000) / freq);
+    LOG(ALWAYS, ", p99 %d ns, max %d ns\n", (ticks[(count * 99) / 100] * 1000000000) / freq,
+                (ticks[count - 1] * 1000000000) / freq);
+}
+
+/**
+ * @brief Create a realm in the new state with a level 0 starting RTT
+ * @param realm - Realm structure
+ * @return VAL_SUCCESS/VAL_ERROR
+ **/
+uint32_t perf_rmi_realm_create(val_host_realm_ts *realm)
+{
+    val_memset(realm, 0, sizeof(val_host_realm_ts));
+
+    realm->s2sz = PERF_IPA_WIDTH;
+    realm->hash_algo = RMI_HASH_SHA_256;
+    realm->s2_starting_level = 0;
+    realm->num_s2_sl_rtts = 1;
+    realm->vmid = 0;
+
+    if (val_host_realm_create_common(realm))
+    {
+        LOG(ERROR, "Realm create failed\n");
+        return VAL_ERROR;
+    }
+
+    return VAL_SUCCESS;
+}
+
+/**
+ * @brief Check that a destroyed realm is unregistered and that none of its RTT,
+ *        DATA, REC or unprotected granules is left in the host tracking
+ * @param rd - RD of the destroyed realm
+ * @param realm_idx - Registry slot the realm used
+ * @return VAL_SUCCESS/VAL_ERROR
+ **/
+uint32_t perf_realm_track_empty(uint64_t rd, int realm_idx)
+{
+    val_host_granule_type_ts *gran_type = &mem_track[realm_idx].gran_type;
+
+    if (mem_track[realm_idx].in_use || val_host_get_curr_realm(rd) != 0)
+    {
+        LOG(ERROR, "Realm still tracked, rd=0x%x\n", rd);
+        return VAL_ERROR;
+    }
+
+    if (gran_type->rtt.count || gran_type->rtt_aux.count)
+    {
+        LOG(ERROR, "RTTs left tracked, rtt %d, aux rtt %d\n", gran_type->rtt.count,
+                                                              gran_type->rtt_aux.count);
+        return VAL_ERROR;
+    }
+
+    if (gran_type->data.count || gran_type->rec.count || gran_type->valid_ns.count)
+    {
+        LOG(ERROR, "Granules left tracked, data %d, rec %d\n", gran_type->data.count,
+                                                               gran_type->rec.count);
+        return VAL_ERROR;
+    }
+
+    return VAL_SUCCESS;
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef _PERF_COMMON_HOST_H_
+#define _PERF_COMMON_HOST_H_
+
+#include "test_database.h"
+#include "val_host_rmi.h"
+
+/* Timed calls of each RMI command */
+#define PERF_RMI_SAMPLES 128
+
+#define PERF_L3_SIZE PAGE_SIZE
+#define PERF_L2_SIZE (512 * PERF_L3_SIZE)
+#define PERF_IPA_WIDTH 40
+#define PERF_IPA_UNPROTECTED (1ULL << (PERF_IPA_WIDTH - 1))
+
+typedef struct {
+    const char *name;
+    uint32_t count;
+    uint64_t start;
+    uint64_t ticks[PERF_RMI_SAMPLES];
+} perf_rmi_samples_ts;
+
+void perf_rmi_samples_init(perf_rmi_samples_ts *samples, const char *name);
+void perf_rmi_sample_start(perf_rmi_samples_ts *samples);
+void perf_rmi_sample_end(perf_rmi_samples_ts *samples);
+void perf_rmi_report(perf_rmi_samples_ts *samples);
+uint32_t perf_rmi_realm_create(val_host_realm_ts *realm);
+uint32_t perf_realm_track_empty(uint64_t rd, int realm_idx);
+#endif /* _PERF_COMMON_HOST_H_ */
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#include "test_database.h"
+#include "val_host_realm.h"
+#include "val_host_alloc.h"
+#include "val_timer.h"
+
+/* Granule addresses outside of the heap, only tracked and never passed to RMM */
+#define PERF_GRANULE_BASE      0x100000000ULL
+#define PERF_UPDATES           1000
+
+static const uint64_t perf_granule_count[] = {1000, 10000, 100000};
+
+#define PERF_NUM_SIZES (sizeof(perf_granule_count) / sizeof(perf_granule_count[0]))
+
+void perf_granule_lookup_host(void)
+{
+    uint64_t cost[PERF_NUM_SIZES];
+    uint64_t freq = val_read_cntfrq_el0();
+    uint64_t tracked = 0, start, pa, i, j;
+    val_host_granule_ts *node;
+
+    for (i = 0; i < PERF_NUM_SIZES; i++)
+    {
+        /* Grow the NS mem_track list to the next size */
+        for (; tracked < perf_granule_count[i]; tracked++)
+            val_host_add_granule(GRANULE_UNDELEGATED, PERF_GRANULE_BASE + tracked * PAGE_SIZE, NULL);
+
+        if (val_host_find_granule(PERF_GRANULE_BASE + (tracked - 1) * PAGE_SIZE) == NULL)
+        {
+            LOG(ERROR, "Failed to track %d granules\n", tracked);
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(1)));
+            goto free_granules;
+        }
+
+        /* Time the lookup, unlink and append done by a granule state update */
+        start = val_read_cntpct_el0();
+        for (j = 0; j < PERF_UPDATES; j++)
+        {
+            pa = PERF_GRANULE_BASE + ((j * 7919) % tracked) * PAGE_SIZE;
+            node = val_host_find_granule(pa);
+            if (node == NULL || val_host_remove_granule(&mem_track[0].gran_type.ns, pa) != node)
+            {
+                LOG(ERROR, "Granule lookup failed, PA=0x%x\n", pa);
+                val_set_status(RESULT_FAIL(VAL_ERROR_POINT(2)));
+                goto free_granules;
+            }
+            val_host_add_granule(node->state, pa, node);
+        }
+        cost[i] = val_read_cntpct_el0() - start;
+
+        LOG(ALWAYS, "\t%d granules : %d ns per update\n", tracked,
+                    (cost[i] * 1000000000) / (freq * PERF_UPDATES));
+    }
+
+    /* Timing depends on the platform and on what else runs, so the growth of
+     * the cost is only reported */
+    LOG(ALWAYS, "\tCost growth from %d to %d granules : x%d\n", perf_granule_count[0],
+                perf_granule_count[PERF_NUM_SIZES - 1],
+                cost[PERF_NUM_SIZES - 1] / (cost[0] ? cost[0] : 1));
+
+    val_set_status(RESULT_PASS(VAL_SUCCESS));
+
+    /* Free test resources */
+free_granules:
+    for (i = 0; i < tracked; i++)
+        val_host_update_destroy_granule_state(0, PERF_GRANULE_BASE + i * PAGE_SIZE, 0, 0,
+                                              GRANULE_UNDELEGATED, 0, 0);
+    return;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#include "test_database.h"
+#include "val_host_realm.h"
+#include "val_host_alloc.h"
+#include "command_common_host.h"
+
+/* Data mapped into each realm */
+#define REALM_DATA_SIZE      0x200000
+#define IPA_DATA             REALM_DATA_SIZE
+/* Enough realms to allocate more than the whole heap over the test */
+#define NUM_ITERATIONS       ((PLATFORM_HEAP_REGION_SIZE / REALM_DATA_SIZE) + 1)
+/* Accepted growth of the heap usage once the first realm has been reclaimed */
+#define RECLAIM_SLACK_PAGES  32
+
+static val_host_realm_ts realm;
+
+void perf_heap_reclaim_host(void)
+{
+    val_data_create_ts data_create;
+    uint64_t src, target, used, steady = 0, peak = 0, i;
+
+    src = (uint64_t)val_host_mem_alloc(PAGE_SIZE, REALM_DATA_SIZE);
+    if (!src)
+    {
+        LOG(ERROR, "val_host_mem_alloc failed\n");
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(1)));
+        return;
+    }
+
+    for (i = 0; i < NUM_ITERATIONS; i++)
+    {
+        val_memset(&realm, 0, sizeof(realm));
+        realm.s2sz = 40;
+        realm.hash_algo = RMI_HASH_SHA_256;
+        realm.s2_starting_level = 0;
+        realm.num_s2_sl_rtts = 1;
+        realm.vmid = 0;
+
+        if (val_host_realm_create_common(&realm))
+        {
+            LOG(ERROR, "Realm create failed, iteration %d\n", i);
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(2)));
+            return;
+        }
+
+        /* The data granules are released by the teardown */
+        target = (uint64_t)val_host_mem_alloc(PAGE_SIZE, REALM_DATA_SIZE);
+        if (!target)
+        {
+            LOG(ERROR, "val_host_mem_alloc failed, iteration %d\n", i);
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(3)));
+            return;
+        }
+
+        data_create.size = REALM_DATA_SIZE;
+        data_create.src_pa = src;
+        data_create.target_pa = target;
+        data_create.ipa = IPA_DATA;
+        data_create.rtt_alignment = PAGE_SIZE;
+        if (val_host_map_protected_data_to_realm(&realm, &data_create))
+        {
+            LOG(ERROR, "val_host_map_protected_data_to_realm failed\n");
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(4)));
+            return;
+        }
+
+        /* Usage peaks while the realm is alive, it must not grow once the
+         * memory of the first realm has been reclaimed */
+        used = val_host_mem_used_pages();
+        if (used > peak)
+            peak = used;
+
+        if (i == 1)
+        {
+            steady = used;
+        } else if ((i > 1) && (used > steady + RECLAIM_SLACK_PAGES)) {
+            LOG(ERROR, "Heap usage grows, %d granules after %d realms\n", used, i);
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(5)));
+            return;
+        }
+
+        /* Destroy the realm and reclaim its memory */
+        if (val_host_postamble())
+        {
+            LOG(ERROR, "val_host_postamble failed\n");
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(6)));
+            return;
+        }
+        val_host_realm_storage_free(&realm);
+    }
+
+    LOG(ALWAYS, "\t%d realms of %d KB : peak %d KB", NUM_ITERATIONS, REALM_DATA_SIZE / 1024,
+                (peak * PAGE_SIZE) / 1024);
+    LOG(ALWAYS, " of %d KB\n", PLATFORM_HEAP_REGION_SIZE / 1024);
+
+    val_set_status(RESULT_PASS(VAL_SUCCESS));
+    return;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#include "perf_common_host.h"
+#include "val_host_journal.h"
+#include "val_timer.h"
+
+/* Commands of a realm setup recorded at most */
+#define JOURNAL_ENTRIES      2048
+#define JOURNAL_REPLAYS      16
+
+static val_host_realm_ts realm;
+static val_host_journal_ts journal;
+
+void perf_journal_replay_host(void)
+{
+    uint64_t freq = val_read_cntfrq_el0();
+    uint64_t start, setup, ticks = 0;
+
+    val_memset(&realm, 0, sizeof(realm));
+    val_host_realm_params(&realm);
+
+    /* Record the setup of an active realm with one REC */
+    if (val_host_journal_start(&journal, JOURNAL_ENTRIES))
+    {
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(1)));
+        return;
+    }
+
+    start = val_read_cntpct_el0();
+    if (val_host_realm_setup(&realm, true))
+    {
+        LOG(ERROR, "Realm setup failed\n");
+        (void)val_host_journal_stop();
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(2)));
+        goto free_journal;
+    }
+    setup = val_read_cntpct_el0() - start;
+
+    if (val_host_journal_stop())
+    {
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(3)));
+        goto free_journal;
+    }
+
+    /* Replays create the realm with the same VMID */
+    if (val_host_realm_destroy(realm.rd))
+    {
+        LOG(ERROR, "val_host_realm_destroy failed\n");
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(4)));
+        goto free_journal;
+    }
+    val_host_realm_storage_free(&realm);
+
+    if (val_host_journal_replay(&journal, JOURNAL_REPLAYS, &ticks))
+    {
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(5)));
+        goto free_journal;
+    }
+
+    LOG(ALWAYS, "\tRealm setup : %d ns, %d commands", (setup * 1000000000) / freq, journal.count);
+    LOG(ALWAYS, ", replay : %d ns, %d ticks\n", (ticks * 1000000000) / (freq * JOURNAL_REPLAYS),
+                ticks / JOURNAL_REPLAYS);
+
+    val_set_status(RESULT_PASS(VAL_SUCCESS));
+
+    /* Free test resources */
+free_journal:
+    val_host_journal_release(&journal);
+    return;
+}
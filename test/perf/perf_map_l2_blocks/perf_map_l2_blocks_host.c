@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#include "perf_common_host.h"
+#include "val_timer.h"
+
+/* 2MB aligned IPA of the region folded into a block */
+#define IPA_BLOCK            PERF_L2_SIZE
+
+static val_host_realm_ts realm;
+
+void perf_map_l2_blocks_host(void)
+{
+    val_data_create_ts data_create;
+    val_host_rtt_entry_ts rtte;
+    uint64_t src, target, start, ticks, ret;
+
+    val_host_map_mode_set(VAL_HOST_MAP_L2_BLOCKS);
+
+    /* The realm is destroyed by the postamble */
+    if (perf_rmi_realm_create(&realm))
+    {
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(1)));
+        return;
+    }
+
+    src = (uint64_t)val_host_mem_alloc(PAGE_SIZE, PERF_L2_SIZE);
+    target = (uint64_t)val_host_mem_alloc_block(VAL_RTT_L2_BLOCK_SIZE, PERF_L2_SIZE);
+    if (!src || !target)
+    {
+        LOG(ERROR, "val_host_mem_alloc failed\n");
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(2)));
+        return;
+    }
+
+    data_create.size = PERF_L2_SIZE;
+    data_create.src_pa = src;
+    data_create.target_pa = target;
+    data_create.ipa = IPA_BLOCK;
+    data_create.rtt_alignment = PAGE_SIZE;
+
+    start = val_read_cntpct_el0();
+    if (val_host_map_protected_data_to_realm(&realm, &data_create))
+    {
+        LOG(ERROR, "val_host_map_protected_data_to_realm failed\n");
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(3)));
+        return;
+    }
+    ticks = val_read_cntpct_el0() - start;
+
+    LOG(ALWAYS, "\t2MB mapped as a block : %d ns\n", (ticks * 1000000000) / val_read_cntfrq_el0());
+
+    /* The region must be mapped by an assigned level 2 block entry */
+    ret = val_host_rmi_rtt_read_entry(realm.rd, IPA_BLOCK, VAL_RTT_BLOCK_LEVEL, &rtte);
+    if (ret)
+    {
+        LOG(ERROR, "RTT read entry failed, ret=0x%x\n", ret);
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(4)));
+        return;
+    }
+
+    if (rtte.walk_level != VAL_RTT_BLOCK_LEVEL || rtte.state != RMI_ASSIGNED)
+    {
+        LOG(ERROR, "Region not mapped by a block, level %d, state %d\n", rtte.walk_level,
+                                                                       rtte.state);
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(5)));
+        return;
+    }
+
+    val_set_status(RESULT_PASS(VAL_SUCCESS));
+    return;
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#include "perf_common_host.h"
+#include "val_timer.h"
+
+/* Smallest range split across the cpus by a parallel population */
+#define POPULATE_SIZE        (4 * PERF_L2_SIZE)
+#define IPA_POPULATE         PERF_L2_SIZE
+
+static val_host_realm_ts realm[2];
+
+/**
+ * @brief Check with RTT_READ_ENTRY that the first and last pages of the
+ *        populated range are assigned with RIPAS RAM
+ * @param realm_ptr - Realm structure
+ * @return VAL_SUCCESS/VAL_ERROR
+ **/
+static uint32_t perf_populate_check(val_host_realm_ts *realm_ptr)
+{
+    val_host_rtt_entry_ts rtte;
+    uint64_t ipa[] = {IPA_POPULATE, IPA_POPULATE + POPULATE_SIZE - PAGE_SIZE};
+    uint64_t ret, i;
+
+    for (i = 0; i < sizeof(ipa) / sizeof(ipa[0]); i++)
+    {
+        ret = val_host_rmi_rtt_read_entry(realm_ptr->rd, ipa[i], VAL_RTT_MAX_LEVEL, &rtte);
+        if (ret)
+        {
+            LOG(ERROR, "RTT read entry failed, ipa=0x%x, ret=0x%x\n", ipa[i], ret);
+            return VAL_ERROR;
+        }
+
+        if (rtte.walk_level != VAL_RTT_MAX_LEVEL || rtte.state != RMI_ASSIGNED ||
+            rtte.ripas != RMI_RAM)
+        {
+            LOG(ERROR, "Page not populated, ipa=0x%x, state %d, ripas %d\n", ipa[i],
+                                                               rtte.state, rtte.ripas);
+            return VAL_ERROR;
+        }
+    }
+
+    return VAL_SUCCESS;
+}
+
+/**
+ * @brief Create a realm, map POPULATE_SIZE of data into it and check the mapping
+ * @param realm_ptr - Realm structure
+ * @param src - Source of the data
+ * @param ticks - Counter ticks taken by the mapping
+ * @return VAL_SUCCESS/VAL_ERROR
+ **/
+static uint32_t perf_populate(val_host_realm_ts *realm_ptr, uint64_t src, uint64_t *ticks)
+{
+    val_data_create_ts data_create;
+    uint64_t target, start;
+
+    if (perf_rmi_realm_create(realm_ptr))
+        return VAL_ERROR;
+
+    target = (uint64_t)val_host_mem_alloc(PERF_L2_SIZE, POPULATE_SIZE);
+    if (!target)
+    {
+        LOG(ERROR, "val_host_mem_alloc failed\n");
+        return VAL_ERROR;
+    }
+
+    data_create.size = POPULATE_SIZE;
+    data_create.src_pa = src;
+    data_create.target_pa = target;
+    data_create.ipa = IPA_POPULATE;
+    data_create.rtt_alignment = PAGE_SIZE;
+
+    start = val_read_cntpct_el0();
+    if (val_host_map_protected_data_to_realm(realm_ptr, &data_create))
+    {
+        LOG(ERROR, "val_host_map_protected_data_to_realm failed\n");
+        return VAL_ERROR;
+    }
+    *ticks = val_read_cntpct_el0() - start;
+
+    return perf_populate_check(realm_ptr);
+}
+
+void perf_populate_parallel_host(void)
+{
+    uint64_t freq = val_read_cntfrq_el0();
+    uint64_t src, serial, parallel;
+
+    src = (uint64_t)val_host_mem_alloc(PAGE_SIZE, POPULATE_SIZE);
+    if (!src)
+    {
+        LOG(ERROR, "val_host_mem_alloc failed\n");
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(1)));
+        return;
+    }
+
+    /* Populate on the primary cpu, then destroy the realm so that its VMID and
+     * memory are available to the second one */
+    if (perf_populate(&realm[0], src, &serial))
+    {
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(2)));
+        return;
+    }
+
+    if (val_host_realm_destroy(realm[0].rd))
+    {
+        LOG(ERROR, "val_host_realm_destroy failed\n");
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(3)));
+        return;
+    }
+    val_host_realm_storage_free(&realm[0]);
+
+    /* Populate the same range with the secondary cpus sharing the work. The
+     * realm is destroyed by the postamble */
+    val_host_populate_mode_set(VAL_HOST_POPULATE_PARALLEL);
+    if (perf_populate(&realm[1], src, &parallel))
+    {
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(4)));
+        return;
+    }
+
+    LOG(ALWAYS, "\tPopulate %d KB : serial %d ns", POPULATE_SIZE / 1024,
+                (serial * 1000000000) / freq);
+    LOG(ALWAYS, ", parallel %d ns\n", (parallel * 1000000000) / freq);
+
+    val_set_status(RESULT_PASS(VAL_SUCCESS));
+    return;
+}
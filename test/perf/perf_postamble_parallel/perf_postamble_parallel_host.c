@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#include "perf_common_host.h"
+#include "command_common_host.h"
+#include "val_timer.h"
+
+#define NUM_REALMS           4
+/* Enough data granules per realm for the postamble to split their teardown */
+#define DATA_PAGES           256
+#define IPA_DATA             PERF_L2_SIZE
+#define NS_PAGES             4
+
+static val_host_realm_ts realm[NUM_REALMS];
+static int realm_idx[NUM_REALMS];
+
+void perf_postamble_parallel_host(void)
+{
+    val_data_create_ts data_create;
+    uint64_t data, ns, start, ticks, i, j;
+
+    val_host_postamble_mode_set(VAL_HOST_POSTAMBLE_PARALLEL);
+
+    for (i = 0; i < NUM_REALMS; i++)
+    {
+        val_memset(&realm[i], 0, sizeof(realm[i]));
+        realm[i].s2sz = PERF_IPA_WIDTH;
+        realm[i].hash_algo = RMI_HASH_SHA_256;
+        realm[i].s2_starting_level = 0;
+        realm[i].num_s2_sl_rtts = 1;
+        realm[i].vmid = (uint16_t)i;
+        realm[i].rec_count = 1;
+
+        if (val_host_realm_create_common(&realm[i]) || val_host_rec_create(&realm[i]))
+        {
+            LOG(ERROR, "Realm create failed, realm %d\n", i);
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(1)));
+            return;
+        }
+        realm_idx[i] = val_host_get_curr_realm(realm[i].rd);
+
+        /* Source granules followed by as many data granules */
+        data = (uint64_t)val_host_mem_alloc(PAGE_SIZE, 2 * DATA_PAGES * PAGE_SIZE);
+        ns = (uint64_t)val_host_mem_alloc(PAGE_SIZE, NS_PAGES * PAGE_SIZE);
+        if (!data || !ns)
+        {
+            LOG(ERROR, "val_host_mem_alloc failed\n");
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(2)));
+            return;
+        }
+
+        data_create.size = DATA_PAGES * PAGE_SIZE;
+        data_create.src_pa = data;
+        data_create.target_pa = data + DATA_PAGES * PAGE_SIZE;
+        data_create.ipa = IPA_DATA;
+        data_create.rtt_alignment = PAGE_SIZE;
+        if (val_host_map_protected_data_to_realm(&realm[i], &data_create))
+        {
+            LOG(ERROR, "val_host_map_protected_data_to_realm failed\n");
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(3)));
+            return;
+        }
+
+        for (j = 0; j < NS_PAGES; j++)
+        {
+            if (val_host_map_unprotected(&realm[i], ns + j * PAGE_SIZE,
+                                         PERF_IPA_UNPROTECTED + j * PAGE_SIZE, PAGE_SIZE, PAGE_SIZE))
+            {
+                LOG(ERROR, "val_host_map_unprotected failed\n");
+                val_set_status(RESULT_FAIL(VAL_ERROR_POINT(4)));
+                return;
+            }
+        }
+    }
+
+    /* Destroy all the realms with the secondary cpus sharing the work */
+    start = val_read_cntpct_el0();
+    if (val_host_postamble())
+    {
+        LOG(ERROR, "val_host_postamble failed\n");
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(5)));
+        return;
+    }
+    ticks = val_read_cntpct_el0() - start;
+
+    LOG(ALWAYS, "\tParallel postamble of %d realms : %d ns\n", NUM_REALMS,
+                (ticks * 1000000000) / val_read_cntfrq_el0());
+
+    for (i = 0; i < NUM_REALMS; i++)
+    {
+        val_host_realm_storage_free(&realm[i]);
+        if (perf_realm_track_empty(realm[i].rd, realm_idx[i]))
+        {
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(6)));
+            return;
+        }
+    }
+
+    val_set_status(RESULT_PASS(VAL_SUCCESS));
+    return;
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#include "perf_common_host.h"
+
+/* L3 table the data granules are mapped in, each IPA is only used once */
+#define IPA_DATA             PERF_L2_SIZE
+#define IPA_DATA_UNKNOWN     (IPA_DATA + PERF_RMI_SAMPLES * PAGE_SIZE)
+
+static val_host_realm_ts realm;
+static uint64_t data[PERF_RMI_SAMPLES];
+static perf_rmi_samples_ts data_create, data_create_unknown, data_destroy;
+
+void perf_rmi_data_host(void)
+{
+    val_host_data_destroy_ts data_destroy_out;
+    uint64_t src, ret;
+    uint32_t i, count = 0;
+    bool data_live = false;
+
+    perf_rmi_samples_init(&data_create, "DATA_CREATE");
+    perf_rmi_samples_init(&data_create_unknown, "DATA_CREATE_UNKNOWN");
+    perf_rmi_samples_init(&data_destroy, "DATA_DESTROY");
+
+    /* The realm is destroyed by the postamble */
+    if (perf_rmi_realm_create(&realm))
+    {
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(1)));
+        return;
+    }
+
+    src = (uint64_t)val_host_mem_alloc(PAGE_SIZE, PAGE_SIZE);
+    if (!src)
+    {
+        LOG(ERROR, "Failed to allocate the source granule\n");
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(2)));
+        return;
+    }
+
+    for (count = 0; count < PERF_RMI_SAMPLES; count++)
+    {
+        data[count] = val_host_granule_pool_get(PAGE_SIZE);
+        if (!data[count])
+        {
+            LOG(ERROR, "Failed to get delegated granules\n");
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(3)));
+            goto free_resources;
+        }
+    }
+
+    if (val_host_create_rtt_levels(&realm, IPA_DATA, 0, 3, PAGE_SIZE) ||
+        val_host_ripas_init(&realm, IPA_DATA, IPA_DATA + PERF_L2_SIZE, VAL_RTT_MAX_LEVEL, PAGE_SIZE))
+    {
+        LOG(ERROR, "Failed to prepare the IPA range\n");
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(4)));
+        goto free_resources;
+    }
+
+    /* DATA_CREATE of all the granules, then DATA_DESTROY of all of them */
+    data_live = true;
+    for (i = 0; i < PERF_RMI_SAMPLES; i++)
+    {
+        perf_rmi_sample_start(&data_create);
+        ret = val_host_rmi_data_create(realm.rd, data[i], IPA_DATA + i * PAGE_SIZE, src,
+                                       RMI_NO_MEASURE_CONTENT);
+        perf_rmi_sample_end(&data_create);
+        if (ret)
+        {
+            LOG(ERROR, "Data create failed, ret=0x%x\n", ret);
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(5)));
+            goto free_resources;
+        }
+    }
+
+    for (i = 0; i < PERF_RMI_SAMPLES; i++)
+    {
+        perf_rmi_sample_start(&data_destroy);
+        ret = val_host_rmi_data_destroy(realm.rd, IPA_DATA + i * PAGE_SIZE, &data_destroy_out);
+        perf_rmi_sample_end(&data_destroy);
+        if (ret)
+        {
+            LOG(ERROR, "Data destroy failed, ret=0x%x\n", ret);
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(6)));
+            goto free_resources;
+        }
+    }
+
+    /* The same granules again with DATA_CREATE_UNKNOWN, at IPAs not used yet */
+    for (i = 0; i < PERF_RMI_SAMPLES; i++)
+    {
+        perf_rmi_sample_start(&data_create_unknown);
+        ret = val_host_rmi_data_create_unknown(realm.rd, data[i], IPA_DATA_UNKNOWN + i * PAGE_SIZE);
+        perf_rmi_sample_end(&data_create_unknown);
+        if (ret)
+        {
+            LOG(ERROR, "Data create unknown failed, ret=0x%x\n", ret);
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(7)));
+            goto free_resources;
+        }
+    }
+
+    for (i = 0; i < PERF_RMI_SAMPLES; i++)
+    {
+        ret = val_host_rmi_data_destroy(realm.rd, IPA_DATA_UNKNOWN + i * PAGE_SIZE,
+                                        &data_destroy_out);
+        if (ret)
+        {
+            LOG(ERROR, "Data destroy failed, ret=0x%x\n", ret);
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(8)));
+            goto free_resources;
+        }
+    }
+    data_live = false;
+
+    perf_rmi_report(&data_create);
+    perf_rmi_report(&data_create_unknown);
+    perf_rmi_report(&data_destroy);
+
+    val_set_status(RESULT_PASS(VAL_SUCCESS));
+
+    /* Free test resources, data granules left mapped by a failure go with the realm */
+free_resources:
+    if (!data_live)
+    {
+        for (i = 0; i < count; i++)
+            val_host_granule_pool_put(data[i]);
+    }
+    val_host_mem_free((void *)src);
+    return;
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#include "perf_common_host.h"
+
+static perf_rmi_samples_ts delegate, undelegate;
+
+void perf_rmi_granule_host(void)
+{
+    uint64_t granule, ret;
+    uint32_t i;
+
+    granule = (uint64_t)val_host_mem_alloc(PAGE_SIZE, PAGE_SIZE);
+    if (!granule)
+    {
+        LOG(ERROR, "Failed to allocate the granule\n");
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(1)));
+        return;
+    }
+
+    perf_rmi_samples_init(&delegate, "GRANULE_DELEGATE");
+    perf_rmi_samples_init(&undelegate, "GRANULE_UNDELEGATE");
+
+    for (i = 0; i < PERF_RMI_SAMPLES; i++)
+    {
+        perf_rmi_sample_start(&delegate);
+        ret = val_host_rmi_granule_delegate(granule);
+        perf_rmi_sample_end(&delegate);
+        if (ret)
+        {
+            LOG(ERROR, "Granule delegate failed, ret=0x%x\n", ret);
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(2)));
+            goto free_granule;
+        }
+
+        perf_rmi_sample_start(&undelegate);
+        ret = val_host_rmi_granule_undelegate(granule);
+        perf_rmi_sample_end(&undelegate);
+        if (ret)
+        {
+            LOG(ERROR, "Granule undelegate failed, ret=0x%x\n", ret);
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(3)));
+            return;
+        }
+    }
+
+    perf_rmi_report(&delegate);
+    perf_rmi_report(&undelegate);
+
+    val_set_status(RESULT_PASS(VAL_SUCCESS));
+
+    /* Free test resources */
+free_granule:
+    val_host_mem_free((void *)granule);
+    return;
+}
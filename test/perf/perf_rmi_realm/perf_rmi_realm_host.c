@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#include "perf_common_host.h"
+
+static perf_rmi_samples_ts realm_create, realm_activate, realm_destroy;
+static perf_rmi_samples_ts rec_create, rec_destroy;
+
+void perf_rmi_realm_host(void)
+{
+    val_host_realm_params_ts *params;
+    val_host_rec_params_ts *rec_params;
+    uint64_t rd, rtt, rec, aux[VAL_MAX_REC_AUX_GRANULES];
+    uint64_t aux_count = 0, ret, j;
+    uint32_t i;
+    bool realm_live = false;
+
+    perf_rmi_samples_init(&realm_create, "REALM_CREATE");
+    perf_rmi_samples_init(&realm_activate, "REALM_ACTIVATE");
+    perf_rmi_samples_init(&realm_destroy, "REALM_DESTROY");
+    perf_rmi_samples_init(&rec_create, "REC_CREATE");
+    perf_rmi_samples_init(&rec_destroy, "REC_DESTROY");
+
+    /* The same delegated granules are used by every realm */
+    rd = val_host_granule_pool_get(PAGE_SIZE);
+    rtt = val_host_granule_pool_get(PAGE_SIZE);
+    rec = val_host_granule_pool_get(PAGE_SIZE);
+    if (!rd || !rtt || !rec)
+    {
+        LOG(ERROR, "Failed to get delegated granules\n");
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(1)));
+        goto free_granules;
+    }
+
+    for (i = 0; i < PERF_RMI_SAMPLES; i++)
+    {
+        params = val_host_scratch_page_get();
+        if (params == NULL)
+        {
+            LOG(ERROR, "Failed to allocate memory for params\n");
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(2)));
+            goto free_granules;
+        }
+
+        params->rtt_base = rtt;
+        params->hash_algo = RMI_HASH_SHA_256;
+        params->s2sz = PERF_IPA_WIDTH;
+        params->rtt_level_start = 0;
+        params->rtt_num_start = 1;
+        params->vmid = 0;
+        params->num_bps = 1;
+        params->num_wps = 1;
+#ifdef RMM_V_1_1
+        params->flags1 = VAL_REALM_FLAG_RTT_TREE_PP;
+#endif
+
+        perf_rmi_sample_start(&realm_create);
+        ret = val_host_rmi_realm_create(rd, (uint64_t)params);
+        perf_rmi_sample_end(&realm_create);
+        val_host_realm_params_reset(params);
+        if (ret)
+        {
+            LOG(ERROR, "Realm create failed, ret=0x%x\n", ret);
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(3)));
+            goto free_granules;
+        }
+        realm_live = true;
+
+        if (i == 0)
+        {
+            ret = val_host_rmi_rec_aux_count(rd, &aux_count);
+            if (ret || aux_count > VAL_MAX_REC_AUX_GRANULES)
+            {
+                LOG(ERROR, "REC AUX count failed, ret=0x%x\n", ret);
+                val_set_status(RESULT_FAIL(VAL_ERROR_POINT(4)));
+                aux_count = 0;
+                goto free_granules;
+            }
+
+            for (j = 0; j < aux_count; j++)
+            {
+                aux[j] = val_host_granule_pool_get(PAGE_SIZE);
+                if (!aux[j])
+                {
+                    LOG(ERROR, "Failed to get delegated granules\n");
+                    val_set_status(RESULT_FAIL(VAL_ERROR_POINT(5)));
+                    aux_count = j;
+                    goto free_granules;
+                }
+            }
+        }
+
+        rec_params = val_host_scratch_page_get();
+        rec_params->num_aux = aux_count;
+        for (j = 0; j < aux_count; j++)
+            rec_params->aux[j] = aux[j];
+        rec_params->mpidr = VAL_HOST_REC_MPIDR(0);
+        rec_params->pc = 0;
+        rec_params->flags = RMI_RUNNABLE;
+
+        perf_rmi_sample_start(&rec_create);
+        ret = val_host_rmi_rec_create(rd, rec, (uint64_t)rec_params);
+        perf_rmi_sample_end(&rec_create);
+        val_host_rec_params_reset(rec_params);
+        if (ret)
+        {
+            LOG(ERROR, "REC create failed, ret=0x%x\n", ret);
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(6)));
+            goto free_granules;
+        }
+
+        perf_rmi_sample_start(&rec_destroy);
+        ret = val_host_rmi_rec_destroy(rec);
+        perf_rmi_sample_end(&rec_destroy);
+        if (ret)
+        {
+            LOG(ERROR, "REC destroy failed, ret=0x%x\n", ret);
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(7)));
+            goto free_granules;
+        }
+
+        perf_rmi_sample_start(&realm_activate);
+        ret = val_host_rmi_realm_activate(rd);
+        perf_rmi_sample_end(&realm_activate);
+        if (ret)
+        {
+            LOG(ERROR, "Realm activate failed, ret=0x%x\n", ret);
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(8)));
+            goto free_granules;
+        }
+
+        perf_rmi_sample_start(&realm_destroy);
+        ret = val_host_rmi_realm_destroy(rd);
+        perf_rmi_sample_end(&realm_destroy);
+        if (ret)
+        {
+            LOG(ERROR, "Realm destroy failed, ret=0x%x\n", ret);
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(9)));
+            goto free_granules;
+        }
+        realm_live = false;
+    }
+
+    perf_rmi_report(&realm_create);
+    perf_rmi_report(&rec_create);
+    perf_rmi_report(&rec_destroy);
+    perf_rmi_report(&realm_activate);
+    perf_rmi_report(&realm_destroy);
+
+    val_set_status(RESULT_PASS(VAL_SUCCESS));
+
+    /* Free test resources, a realm left by a failure is destroyed by the postamble */
+free_granules:
+    if (realm_live)
+        return;
+
+    for (j = 0; j < aux_count; j++)
+        val_host_granule_pool_put(aux[j]);
+    if (rec)
+        val_host_granule_pool_put(rec);
+    if (rtt)
+        val_host_granule_pool_put(rtt);
+    if (rd)
+        val_host_granule_pool_put(rd);
+    return;
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#include "perf_common_host.h"
+
+/* L3 table created and destroyed by each iteration */
+#define IPA_RTT_CREATE       PERF_L2_SIZE
+/* L3 table whose entries are read and initialised to RIPAS RAM */
+#define IPA_RTT_ENTRY        (2 * PERF_L2_SIZE)
+/* L3 table of data granules folded into a block by each iteration */
+#define IPA_RTT_FOLD         (4 * PERF_L2_SIZE)
+#define IPA_UNPROTECTED      PERF_IPA_UNPROTECTED
+
+static val_host_realm_ts realm;
+static perf_rmi_samples_ts rtt_create, rtt_destroy, rtt_fold, read_entry, init_ripas;
+static perf_rmi_samples_ts map_unprotected, unmap_unprotected;
+
+void perf_rmi_rtt_host(void)
+{
+    val_host_rtt_destroy_ts rtt_destroy_out;
+    val_host_rtt_entry_ts rtte;
+    val_data_create_ts data_create;
+    uint64_t rtt = 0, ns = 0, phys, out_top, ipa, ret;
+    uint32_t i;
+    bool rtt_live = false, ns_mapped = false;
+
+    perf_rmi_samples_init(&rtt_create, "RTT_CREATE");
+    perf_rmi_samples_init(&rtt_destroy, "RTT_DESTROY");
+    perf_rmi_samples_init(&rtt_fold, "RTT_FOLD");
+    perf_rmi_samples_init(&read_entry, "RTT_READ_ENTRY");
+    perf_rmi_samples_init(&init_ripas, "RTT_INIT_RIPAS");
+    perf_rmi_samples_init(&map_unprotected, "RTT_MAP_UNPROTECTED");
+    perf_rmi_samples_init(&unmap_unprotected, "RTT_UNMAP_UNPROTECTED");
+
+    /* The realm is destroyed by the postamble */
+    if (perf_rmi_realm_create(&realm))
+    {
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(1)));
+        return;
+    }
+
+    /* RTT_CREATE and RTT_DESTROY of the same L3 table */
+    rtt = val_host_granule_pool_get(PAGE_SIZE);
+    if (!rtt || val_host_create_rtt_levels(&realm, IPA_RTT_CREATE, 0, 2, PAGE_SIZE))
+    {
+        LOG(ERROR, "Failed to create the RTTs\n");
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(2)));
+        goto free_resources;
+    }
+
+    for (i = 0; i < PERF_RMI_SAMPLES; i++)
+    {
+        perf_rmi_sample_start(&rtt_create);
+        ret = val_host_rmi_rtt_create(realm.rd, rtt, IPA_RTT_CREATE, 3);
+        perf_rmi_sample_end(&rtt_create);
+        if (ret)
+        {
+            LOG(ERROR, "RTT create failed, ret=0x%x\n", ret);
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(3)));
+            goto free_resources;
+        }
+        rtt_live = true;
+
+        perf_rmi_sample_start(&rtt_destroy);
+        ret = val_host_rmi_rtt_destroy(realm.rd, IPA_RTT_CREATE, 3, &rtt_destroy_out);
+        perf_rmi_sample_end(&rtt_destroy);
+        if (ret)
+        {
+            LOG(ERROR, "RTT destroy failed, ret=0x%x\n", ret);
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(4)));
+            goto free_resources;
+        }
+        rtt_live = false;
+    }
+
+    /* RTT_READ_ENTRY and RTT_INIT_RIPAS of a new page each time */
+    if (val_host_create_rtt_levels(&realm, IPA_RTT_ENTRY, 0, 3, PAGE_SIZE))
+    {
+        LOG(ERROR, "Failed to create the RTTs\n");
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(5)));
+        goto free_resources;
+    }
+
+    for (i = 0; i < PERF_RMI_SAMPLES; i++)
+    {
+        ipa = IPA_RTT_ENTRY + i * PAGE_SIZE;
+
+        perf_rmi_sample_start(&read_entry);
+        ret = val_host_rmi_rtt_read_entry(realm.rd, ipa, 3, &rtte);
+        perf_rmi_sample_end(&read_entry);
+        if (ret)
+        {
+            LOG(ERROR, "RTT read entry failed, ret=0x%x\n", ret);
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(6)));
+            goto free_resources;
+        }
+
+        perf_rmi_sample_start(&init_ripas);
+        ret = val_host_rmi_rtt_init_ripas(realm.rd, ipa, ipa + PAGE_SIZE, &out_top);
+        perf_rmi_sample_end(&init_ripas);
+        if (ret)
+        {
+            LOG(ERROR, "RTT init ripas failed, ret=0x%x\n", ret);
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(7)));
+            goto free_resources;
+        }
+    }
+
+    /* RTT_MAP_UNPROTECTED and RTT_UNMAP_UNPROTECTED of the same page */
+    ns = (uint64_t)val_host_mem_alloc(PAGE_SIZE, PAGE_SIZE);
+    if (!ns || val_host_create_rtt_levels(&realm, IPA_UNPROTECTED, 0, 3, PAGE_SIZE))
+    {
+        LOG(ERROR, "Failed to create the RTTs\n");
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(8)));
+        goto free_resources;
+    }
+
+    for (i = 0; i < PERF_RMI_SAMPLES; i++)
+    {
+        perf_rmi_sample_start(&map_unprotected);
+        ret = val_host_rmi_rtt_map_unprotected(realm.rd, IPA_UNPROTECTED, 3,
+                                               ns | ATTR_NORMAL_WB_WA_RA | ATTR_STAGE2_AP_RW);
+        perf_rmi_sample_end(&map_unprotected);
+        if (ret)
+        {
+            LOG(ERROR, "RTT map unprotected failed, ret=0x%x\n", ret);
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(9)));
+            goto free_resources;
+        }
+        ns_mapped = true;
+
+        perf_rmi_sample_start(&unmap_unprotected);
+        ret = val_host_rmi_rtt_unmap_unprotected(realm.rd, IPA_UNPROTECTED, 3, &out_top);
+        perf_rmi_sample_end(&unmap_unprotected);
+        if (ret)
+        {
+            LOG(ERROR, "RTT unmap unprotected failed, ret=0x%x\n", ret);
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(10)));
+            goto free_resources;
+        }
+        ns_mapped = false;
+    }
+
+    /* RTT_FOLD of an L3 table of data granules, unfolded again by RTT_CREATE */
+    phys = (uint64_t)val_host_mem_alloc(PERF_L2_SIZE, 2 * PERF_L2_SIZE);
+    if (!phys)
+    {
+        LOG(ERROR, "val_host_mem_alloc failed\n");
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(11)));
+        goto free_resources;
+    }
+
+    data_create.size = PERF_L2_SIZE;
+    data_create.src_pa = phys;
+    data_create.target_pa = phys + PERF_L2_SIZE;
+    data_create.ipa = IPA_RTT_FOLD;
+    data_create.rtt_alignment = PAGE_SIZE;
+    if (val_host_map_protected_data_to_realm(&realm, &data_create))
+    {
+        LOG(ERROR, "val_host_map_protected_data_to_realm failed\n");
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(12)));
+        goto free_resources;
+    }
+
+    for (i = 0; i < PERF_RMI_SAMPLES; i++)
+    {
+        perf_rmi_sample_start(&rtt_fold);
+        ret = val_host_rmi_rtt_fold(realm.rd, IPA_RTT_FOLD, 3, &rtt_destroy_out.rtt);
+        perf_rmi_sample_end(&rtt_fold);
+        if (ret)
+        {
+            LOG(ERROR, "RTT fold failed, ret=0x%x\n", ret);
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(13)));
+            goto free_resources;
+        }
+
+        ret = val_host_rmi_rtt_create(realm.rd, rtt_destroy_out.rtt, IPA_RTT_FOLD, 3);
+        if (ret)
+        {
+            LOG(ERROR, "RTT create failed, ret=0x%x\n", ret);
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(14)));
+            goto free_resources;
+        }
+    }
+
+    perf_rmi_report(&rtt_create);
+    perf_rmi_report(&rtt_destroy);
+    perf_rmi_report(&rtt_fold);
+    perf_rmi_report(&read_entry);
+    perf_rmi_report(&init_ripas);
+    perf_rmi_report(&map_unprotected);
+    perf_rmi_report(&unmap_unprotected);
+
+    val_set_status(RESULT_PASS(VAL_SUCCESS));
+
+    /* Free test resources */
+free_resources:
+    if (rtt && !rtt_live)
+        val_host_granule_pool_put(rtt);
+    if (ns && !ns_mapped)
+        val_host_mem_free((void *)ns);
+    return;
+}
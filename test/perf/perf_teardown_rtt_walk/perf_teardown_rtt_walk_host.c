@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#include "perf_common_host.h"
+#include "command_common_host.h"
+#include "val_timer.h"
+
+/* Data granules mapped with page entries */
+#define IPA_DATA             PERF_L2_SIZE
+#define DATA_PAGES           8
+/* 2MB of data folded into a level 2 block entry */
+#define IPA_BLOCK            (2 * PERF_L2_SIZE)
+/* Auxiliary RTTs of plane 1 down to level 3 */
+#define IPA_AUX              (4 * PERF_L2_SIZE)
+#define AUX_INDEX            1
+#define NS_PAGES             4
+
+static val_host_realm_ts realm;
+
+void perf_teardown_rtt_walk_host(void)
+{
+    val_data_create_ts data_create;
+    uint64_t data, block, ns, rtt, start, ticks, i;
+    int realm_idx;
+
+    val_host_realm_teardown_mode_set(VAL_HOST_TEARDOWN_RTT_WALK);
+    /* Compare the RTT shadow with RMM while the RTTs are built */
+    val_host_rtt_shadow_check_set(true);
+
+    val_memset(&realm, 0, sizeof(realm));
+    realm.s2sz = PERF_IPA_WIDTH;
+    realm.hash_algo = RMI_HASH_SHA_256;
+    realm.s2_starting_level = 0;
+    realm.num_s2_sl_rtts = 1;
+    realm.vmid = 0;
+
+#ifdef RMM_V_1_1
+    /* Auxiliary RTTs need an RTT tree per plane */
+    if (val_host_rmm_supports_planes() && val_host_rmm_supports_rtt_tree_per_plane())
+    {
+        val_host_realm_flags1_ts realm_flags;
+
+        val_memset(&realm_flags, 0, sizeof(realm_flags));
+        realm_flags.rtt_tree_pp = RMI_FEATURE_TRUE;
+        val_memcpy(&realm.flags1, &realm_flags, sizeof(realm.flags1));
+        realm.num_aux_planes = 1;
+    } else {
+        LOG(ALWAYS, "No support for RTT tree per plane, no auxiliary RTTs\n");
+    }
+#endif
+
+    if (val_host_realm_create_common(&realm))
+    {
+        LOG(ERROR, "Realm create failed\n");
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(1)));
+        return;
+    }
+
+    /* Source granules followed by as many data granules */
+    data = (uint64_t)val_host_mem_alloc(PAGE_SIZE, 2 * DATA_PAGES * PAGE_SIZE);
+    block = (uint64_t)val_host_mem_alloc(PERF_L2_SIZE, 2 * PERF_L2_SIZE);
+    ns = (uint64_t)val_host_mem_alloc(PAGE_SIZE, NS_PAGES * PAGE_SIZE);
+    if (!data || !block || !ns)
+    {
+        LOG(ERROR, "val_host_mem_alloc failed\n");
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(2)));
+        return;
+    }
+
+    data_create.size = DATA_PAGES * PAGE_SIZE;
+    data_create.src_pa = data;
+    data_create.target_pa = data + DATA_PAGES * PAGE_SIZE;
+    data_create.ipa = IPA_DATA;
+    data_create.rtt_alignment = PAGE_SIZE;
+    if (val_host_map_protected_data_to_realm(&realm, &data_create))
+    {
+        LOG(ERROR, "val_host_map_protected_data_to_realm failed\n");
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(3)));
+        return;
+    }
+
+    data_create.size = PERF_L2_SIZE;
+    data_create.src_pa = block;
+    data_create.target_pa = block + PERF_L2_SIZE;
+    data_create.ipa = IPA_BLOCK;
+    if (val_host_map_protected_data_to_realm(&realm, &data_create))
+    {
+        LOG(ERROR, "val_host_map_protected_data_to_realm failed\n");
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(4)));
+        return;
+    }
+
+    if (val_host_rmi_rtt_fold(realm.rd, IPA_BLOCK, VAL_RTT_MAX_LEVEL, &rtt) ||
+        val_host_granule_pool_put(rtt))
+    {
+        LOG(ERROR, "RTT fold failed, ipa=0x%x\n", IPA_BLOCK);
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(5)));
+        return;
+    }
+
+    for (i = 0; i < NS_PAGES; i++)
+    {
+        if (val_host_map_unprotected(&realm, ns + i * PAGE_SIZE,
+                                     PERF_IPA_UNPROTECTED + i * PAGE_SIZE, PAGE_SIZE, PAGE_SIZE))
+        {
+            LOG(ERROR, "val_host_map_unprotected failed\n");
+            val_set_status(RESULT_FAIL(VAL_ERROR_POINT(6)));
+            return;
+        }
+    }
+
+    if (realm.num_aux_planes &&
+        val_host_create_aux_rtt_levels(&realm, IPA_AUX, 0, VAL_RTT_MAX_LEVEL, PAGE_SIZE, AUX_INDEX))
+    {
+        LOG(ERROR, "Aux RTT create failed\n");
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(7)));
+        return;
+    }
+
+    if (val_host_rtt_shadow_mismatch(realm.rd))
+    {
+        LOG(ERROR, "RTT shadow mismatched RMM while building the RTTs\n");
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(8)));
+        return;
+    }
+
+    /* Tear the realm down with a single walk of each RTT tree */
+    realm_idx = val_host_get_curr_realm(realm.rd);
+    start = val_read_cntpct_el0();
+    if (val_host_realm_destroy(realm.rd))
+    {
+        LOG(ERROR, "val_host_realm_destroy failed\n");
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(9)));
+        return;
+    }
+    ticks = val_read_cntpct_el0() - start;
+    val_host_realm_storage_free(&realm);
+
+    LOG(ALWAYS, "\tRTT walk teardown : %d ns\n", (ticks * 1000000000) / val_read_cntfrq_el0());
+
+    if (perf_realm_track_empty(realm.rd, realm_idx))
+    {
+        val_set_status(RESULT_FAIL(VAL_ERROR_POINT(10)));
+        return;
+    }
+
+    val_set_status(RESULT_PASS(VAL_SUCCESS));
+    return;
+}
@@ -95,6 +95,13 @@
 #define VAL_PLANE1_IMAGE_BASE_IPA 0x500000
 #define VAL_PLANE2_IMAGE_BASE_IPA 0x600000
 
+/* Header of the realm image at VAL_REALM_IMAGE_HEADER_OFFSET, after the
+ * branch to the entry code. Filled in at link time with the extent of the
+ * image: the loaded part (text, rodata, data, rela) and the whole image
+ * including bss and translation tables. */
+#define VAL_REALM_IMAGE_HEADER_OFFSET 0x8
+#define VAL_REALM_IMAGE_MAGIC         0x474d494d4c414552
+
 /* Use this macro for test use IPA */
 #define VAL_TEST_USE_IPA 0x0
 
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef _VAL_TRACE_H_
+#define _VAL_TRACE_H_
+
+#include "val.h"
+
+/* Records kept per cpu, the oldest are overwritten first. Power of two */
+#define VAL_TRACE_RING_ENTRIES  32
+
+/* Distinct FIDs a cpu keeps latency histograms for */
+#define VAL_TRACE_MAX_FIDS      32
+
+/* Bucket n counts calls of 2^n to 2^(n+1) - 1 ticks, the last one is open ended */
+#define VAL_TRACE_HIST_BUCKETS  24
+
+typedef struct {
+    uint64_t fid;
+    uint64_t x1;
+    uint64_t x2;
+    uint64_t x3;
+    uint64_t ret;
+    /* CNTPCT_EL0 before and after the call */
+    uint64_t start;
+    uint64_t end;
+} val_trace_record_ts;
+
+typedef struct {
+    uint32_t fid;
+    uint32_t count;
+    uint64_t total;
+    uint64_t max;
+    uint32_t hist[VAL_TRACE_HIST_BUCKETS];
+} val_trace_fid_ts;
+
+typedef struct {
+    val_trace_record_ts ring[VAL_TRACE_RING_ENTRIES];
+    /* Records written so far, the next one goes to head % VAL_TRACE_RING_ENTRIES */
+    uint64_t head;
+    /* Calls left out of the histograms once fids[] is full */
+    uint32_t untracked;
+    uint32_t fid_count;
+    val_trace_fid_ts fids[VAL_TRACE_MAX_FIDS];
+} val_trace_cpu_ts;
+
+void val_trace_record(uint64_t fid, uint64_t x1, uint64_t x2, uint64_t x3,
+                      uint64_t ret, uint64_t start, uint64_t end);
+void val_trace_dump(void);
+void val_trace_reset(void);
+#endif /* _VAL_TRACE_H_ */
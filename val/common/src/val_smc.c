@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2023, Arm Limited or its affiliates. All rights reserved.
+ * Copyright (c) 2023, 2025, Arm Limited or its affiliates. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -7,6 +7,10 @@
 
 
 #include "val_smc.h"
+#ifdef VAL_SMC_TRACE
+#include "val_trace.h"
+#include "val_timer.h"
+#endif
 
 /* SMC call */
 val_smc_param_ts val_smc_call(uint64_t x0, uint64_t x1, uint64_t x2,
@@ -15,6 +19,9 @@ val_smc_param_ts val_smc_call(uint64_t x0, uint64_t x1, uint64_t x2,
                                 uint64_t x9, uint64_t x10)
 {
     val_smc_param_ts args;
+#ifdef VAL_SMC_TRACE
+    uint64_t start;
+#endif
 
     args.x0 = x0;
     args.x1 = x1;
@@ -27,6 +34,12 @@ val_smc_param_ts val_smc_call(uint64_t x0, uint64_t x1, uint64_t x2,
     args.x8 = x8;
     args.x9 = x9;
     args.x10 = x10;
+#ifdef VAL_SMC_TRACE
+    start = val_read_cntpct_el0();
+#endif
     val_smc_call_asm(&args);
+#ifdef VAL_SMC_TRACE
+    val_trace_record(x0, x1, x2, x3, args.x0, start, val_read_cntpct_el0());
+#endif
     return args;
 }
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include "val_trace.h"
+#include "val_libc.h"
+#include "val_mp_supp.h"
+#include "val_timer.h"
+
+#ifdef VAL_SMC_TRACE
+
+/* Each cpu only writes its own entry, so recording takes no lock */
+static val_trace_cpu_ts trace_cpu[PLATFORM_CPU_COUNT];
+
+/* Set while printing, the calls made by the prints themselves aren't recorded */
+static volatile bool trace_dumping;
+
+/**
+ * @brief Log2 histogram bucket of a call duration
+ * @param ticks - Duration of the call in CNTPCT ticks
+ * @return Bucket index
+ **/
+static uint32_t val_trace_bucket(uint64_t ticks)
+{
+    uint32_t bucket;
+
+    if (ticks == 0)
+        return 0;
+
+    bucket = (uint32_t)(63 - __builtin_clzll(ticks));
+    if (bucket >= VAL_TRACE_HIST_BUCKETS)
+        bucket = VAL_TRACE_HIST_BUCKETS - 1;
+
+    return bucket;
+}
+
+/**
+ * @brief Find the histogram of a FID, claiming a free one on first use
+ * @param trace - Trace state of the calling cpu
+ * @param fid - Function ID of the call
+ * @return Histogram of the FID, NULL if the table is full
+ **/
+static val_trace_fid_ts *val_trace_fid(val_trace_cpu_ts *trace, uint32_t fid)
+{
+    uint32_t i;
+
+    for (i = 0; i < trace->fid_count; i++)
+    {
+        if (trace->fids[i].fid == fid)
+            return &trace->fids[i];
+    }
+
+    if (trace->fid_count == VAL_TRACE_MAX_FIDS)
+        return NULL;
+
+    trace->fids[trace->fid_count].fid = fid;
+    return &trace->fids[trace->fid_count++];
+}
+
+/**
+ * @brief Record an SMC or HVC call in the ring and the histograms of the calling cpu
+ * @param fid - Function ID passed in x0
+ * @param x1 - First argument
+ * @param x2 - Second argument
+ * @param x3 - Third argument
+ * @param ret - Value returned in x0
+ * @param start - CNTPCT_EL0 before the call
+ * @param end - CNTPCT_EL0 after the call
+ * @return void
+ **/
+void val_trace_record(uint64_t fid, uint64_t x1, uint64_t x2, uint64_t x3,
+                      uint64_t ret, uint64_t start, uint64_t end)
+{
+    val_trace_cpu_ts *trace;
+    val_trace_record_ts *record;
+    val_trace_fid_ts *hist;
+    uint64_t ticks = end - start;
+    uint32_t cpu;
+
+    if (trace_dumping)
+        return;
+
+    cpu = val_get_cpuid(val_read_mpidr());
+    if (cpu >= PLATFORM_CPU_COUNT)
+        return;
+
+    trace = &trace_cpu[cpu];
+    record = &trace->ring[trace->head & (VAL_TRACE_RING_ENTRIES - 1)];
+    record->fid = fid;
+    record->x1 = x1;
+    record->x2 = x2;
+    record->x3 = x3;
+    record->ret = ret;
+    record->start = start;
+    record->end = end;
+    trace->head++;
+
+    hist = val_trace_fid(trace, (uint32_t)fid);
+    if (hist == NULL)
+    {
+        trace->untracked++;
+        return;
+    }
+
+    hist->count++;
+    hist->total += ticks;
+    if (ticks > hist->max)
+        hist->max = ticks;
+    hist->hist[val_trace_bucket(ticks)]++;
+}
+
+/**
+ * @brief Print the latency histograms of a FID, summed over the cpus
+ * @param fid - Function ID
+ * @return void
+ **/
+static void val_trace_dump_fid(uint32_t fid)
+{
+    val_trace_fid_ts *hist;
+    uint64_t count = 0, total = 0, max = 0, bucket_count;
+    uint32_t cpu, i, bucket;
+
+    for (cpu = 0; cpu < PLATFORM_CPU_COUNT; cpu++)
+    {
+        for (i = 0; i < trace_cpu[cpu].fid_count; i++)
+        {
+            hist = &trace_cpu[cpu].fids[i];
+            if (hist->fid != fid)
+                continue;
+
+            count += hist->count;
+            total += hist->total;
+            if (hist->max > max)
+                max = hist->max;
+        }
+    }
+
+    LOG(ALWAYS, "\t  fid 0x%x : %d calls, avg %d ticks", fid, count, total / count);
+    LOG(ALWAYS, ", max %d ticks\n", max);
+
+    for (bucket = 0; bucket < VAL_TRACE_HIST_BUCKETS; bucket++)
+    {
+        bucket_count = 0;
+        for (cpu = 0; cpu < PLATFORM_CPU_COUNT; cpu++)
+        {
+            for (i = 0; i < trace_cpu[cpu].fid_count; i++)
+            {
+                if (trace_cpu[cpu].fids[i].fid == fid)
+                    bucket_count += trace_cpu[cpu].fids[i].hist[bucket];
+            }
+        }
+
+        if (bucket_count != 0)
+            LOG(INFO, "\t    >= 2^%d ticks : %d\n", bucket, bucket_count);
+    }
+}
+
+/**
+ * @brief Print the latency histograms of every FID called, then the
+ *        records still in the ring of each cpu, oldest first
+ * @param void
+ * @return void
+ **/
+void val_trace_dump(void)
+{
+    val_trace_record_ts *record;
+    uint64_t seq, first;
+    uint32_t cpu, prev, i, j;
+    bool seen;
+
+    trace_dumping = true;
+
+    LOG(ALWAYS, "\tSMC/HVC call trace :\n");
+    for (cpu = 0; cpu < PLATFORM_CPU_COUNT; cpu++)
+    {
+        for (i = 0; i < trace_cpu[cpu].fid_count; i++)
+        {
+            /* Print each FID once, from the first cpu that called it */
+            seen = false;
+            for (prev = 0; prev <= cpu && !seen; prev++)
+            {
+                for (j = 0; j < trace_cpu[prev].fid_count; j++)
+                {
+                    if (prev == cpu && j == i)
+                        break;
+
+                    if (trace_cpu[prev].fids[j].fid == trace_cpu[cpu].fids[i].fid)
+                    {
+                        seen = true;
+                        break;
+                    }
+                }
+            }
+
+            if (!seen)
+                val_trace_dump_fid(trace_cpu[cpu].fids[i].fid);
+        }
+
+        if (trace_cpu[cpu].untracked != 0)
+            LOG(WARN, "\t  cpu %d : %d calls not in the histograms\n",
+                        cpu, trace_cpu[cpu].untracked);
+    }
+
+    for (cpu = 0; cpu < PLATFORM_CPU_COUNT; cpu++)
+    {
+        if (trace_cpu[cpu].head == 0)
+            continue;
+
+        first = 0;
+        if (trace_cpu[cpu].head > VAL_TRACE_RING_ENTRIES)
+            first = trace_cpu[cpu].head - VAL_TRACE_RING_ENTRIES;
+
+        LOG(INFO, "\t  cpu %d : last %d calls\n", cpu, trace_cpu[cpu].head - first);
+        for (seq = first; seq < trace_cpu[cpu].head; seq++)
+        {
+            record = &trace_cpu[cpu].ring[seq & (VAL_TRACE_RING_ENTRIES - 1)];
+            LOG(INFO, "\t    fid 0x%x x1 0x%x", record->fid, record->x1);
+            LOG(INFO, " x2 0x%x x3 0x%x", record->x2, record->x3);
+            LOG(INFO, " ret 0x%x ticks %d\n", record->ret, record->end - record->start);
+        }
+    }
+
+    trace_dumping = false;
+}
+
+/**
+ * @brief Clear the rings and histograms of all the cpus
+ * @param void
+ * @return void
+ **/
+void val_trace_reset(void)
+{
+    uint32_t cpu;
+
+    for (cpu = 0; cpu < PLATFORM_CPU_COUNT; cpu++)
+        val_memset(&trace_cpu[cpu], 0, sizeof(val_trace_cpu_ts));
+}
+#endif /* VAL_SMC_TRACE */
@@ -14,10 +14,38 @@
 #define __ADDR_ALIGN_MASK(a, mask)    (((a) + (mask)) & ~(mask))
 #define ADDR_ALIGN(a, b)              __ADDR_ALIGN_MASK(a, (typeof(a))(b) - 1)
 
+/* Purpose of heap memory, used for usage accounting */
+typedef enum {
+    VAL_HOST_MEM_TAG_OTHER = 0,
+    VAL_HOST_MEM_TAG_RD,
+    VAL_HOST_MEM_TAG_RTT,
+    VAL_HOST_MEM_TAG_RTT_AUX,
+    VAL_HOST_MEM_TAG_REC,
+    VAL_HOST_MEM_TAG_REC_AUX,
+    VAL_HOST_MEM_TAG_DATA,
+    VAL_HOST_MEM_TAG_RUN,
+    VAL_HOST_MEM_TAG_PARAMS,
+    VAL_HOST_MEM_TAG_TRACK,
+    VAL_HOST_MEM_TAG_REALM,
+    VAL_HOST_MEM_TAG_POOL,
+    VAL_HOST_MEM_TAG_COUNT
+} val_host_mem_tag_te;
+
 void val_host_mem_alloc_init(void);
 void *val_host_mem_alloc(size_t alignment, size_t size);
+void *val_host_mem_alloc_block(size_t block_size, size_t size);
+void *val_host_mem_alloc_tag(size_t alignment, size_t size, val_host_mem_tag_te tag);
+void val_host_mem_set_tag(uint64_t addr, val_host_mem_tag_te tag);
+void *val_host_scratch_page_get(void);
+void val_host_mem_usage_report(void);
+void val_host_mem_usage_summary(void);
 void val_host_mem_free(void *ptr);
+void val_host_mem_free_granule(uint64_t addr);
+uint64_t val_host_mem_used_pages(void);
 void *mem_alloc(size_t alignment, size_t size);
 uint16_t val_host_get_vmid(void);
+uint64_t val_host_granule_pool_get(size_t alignment);
+uint32_t val_host_granule_pool_put(uint64_t addr);
+uint32_t val_host_granule_pool_shrink(uint32_t count);
 
 #endif /* _VAL_HOST_ALLOC_H_ */
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef _VAL_HOST_JOURNAL_H_
+#define _VAL_HOST_JOURNAL_H_
+
+#include "val_host_realm.h"
+
+/* Arguments of a recorded RMI command, x1 to x5 */
+#define VAL_HOST_JOURNAL_ARGS 5
+
+/* Granules of the replay region keep the alignment they had, up to this */
+#define VAL_HOST_JOURNAL_ALIGN_MAX 0x10000
+
+typedef struct {
+    uint32_t fid;
+    /* Bit n set: argument n is the PA of a granule of the realm */
+    uint8_t granule_args;
+    /* Index + 1 of the argument pointing to a params copy, 0 if none */
+    uint8_t params_arg;
+    uint16_t reserved;
+    uint64_t args[VAL_HOST_JOURNAL_ARGS];
+    /* Status returned when recorded, expected on replay */
+    uint64_t status;
+} val_host_journal_entry_ts;
+
+typedef struct {
+    val_host_journal_entry_ts *entries;
+    uint32_t count;
+    uint32_t max_entries;
+    /* PAs of the granules of the realm, sorted when the recording stops */
+    uint64_t *granules;
+    /* Offset of each granule in the replay region */
+    uint64_t *offsets;
+    uint32_t granule_count;
+    uint32_t max_granules;
+    /* Delegated granules used in place of the recorded ones by replays */
+    uint64_t region;
+    uint64_t region_size;
+    uint32_t delegated;
+    bool overflow;
+    bool unsupported;
+    bool prepared;
+} val_host_journal_ts;
+
+uint32_t val_host_journal_start(val_host_journal_ts *journal, uint32_t max_entries);
+uint32_t val_host_journal_stop(void);
+void val_host_journal_record(uint64_t fid, uint64_t x1, uint64_t x2, uint64_t x3,
+                             uint64_t x4, uint64_t x5, uint64_t status);
+uint32_t val_host_journal_replay(val_host_journal_ts *journal, uint32_t count, uint64_t *ticks);
+void val_host_journal_release(val_host_journal_ts *journal);
+#endif /* _VAL_HOST_JOURNAL_H_ */
@@ -14,7 +14,7 @@
 
 #include "xlat_tables_v2.h"
 
-#define HOST_MEM_REGIONS 12
+#define HOST_MEM_REGIONS 13
 
 #define ACS_HOST_CTX_MAX_XLAT_TABLES 40
 
@@ -11,7 +11,11 @@
 #include "val_host_rmi.h"
 #include "val_libc.h"
 
-#define VAL_MAX_REC_COUNT 8
+/* Initial REC and mapped region slots of a realm, grown on demand */
+#define VAL_HOST_REC_SLOTS_MIN 8
+
+/* MPIDR of the REC at an index, with at most 16 RECs per Aff0 range */
+#define VAL_HOST_REC_MPIDR(index) ((((uint64_t)(index) >> 4) << 8) | ((uint64_t)(index) & 0xFUL))
 
 #define VAL_RTT_BLOCK_LEVEL    2
 #define VAL_RTT_MAX_LEVEL    3
@@ -22,6 +26,7 @@
 #define VAL_PAGE_SHIFT        12
 #define VAL_RTT_LEVEL_SHIFT(level)    ((VAL_PAGE_SHIFT - 3) * (4 - (level)) + 3)
 #define VAL_RTT_L2_BLOCK_SIZE    (1UL << VAL_RTT_LEVEL_SHIFT(2))
+#define VAL_RTT_L1_BLOCK_SIZE    (1UL << VAL_RTT_LEVEL_SHIFT(1))
 
 #define VAL_REC_NUM_GPRS                      8
 #define VAL_REC_HVC_NUM_GPRS                 31
@@ -33,9 +38,9 @@
 
 #define VAL_MAX_REC_AUX_GRANULES 16
 #define VAL_MAX_RTT_GRANULES 25
-#define VAL_MAX_GRANULES_MAP 25
+#define VAL_HOST_GRANULES_MAP_MIN 32
 
-#define VAL_HOST_MAX_REALMS 10
+#define VAL_HOST_REALM_SLOTS_MIN 16
 #define SET_MEMBER_RMI    SET_MEMBER
 
 #define REALM_FLAG_PMU_ENABLE (1UL << 2)
@@ -99,18 +104,28 @@ typedef struct {
     uint64_t image_pa_base;
     uint64_t aux_image_pa_base[VAL_MAX_AUX_PLANES];
     uint64_t image_pa_size;
+    uint64_t image_load_size;
     uint64_t rd;
     uint64_t rtt_l0_addr;
     uint64_t rtt_aux_l0_addr[VAL_MAX_AUX_PLANES];
     uint64_t granules_mapped_count;
-    val_host_granules_mapped_ts granules[VAL_MAX_GRANULES_MAP];
-    uint64_t rec[VAL_MAX_REC_COUNT];
-    uint64_t run[VAL_MAX_REC_COUNT];
+    uint64_t granules_mapped_slots;
+    val_host_granules_mapped_ts *granules;
+    uint64_t rec_slots;
+    uint64_t *rec;
+    uint64_t *run;
     uint64_t aux_count;
-    uint64_t rec_aux_granules[VAL_MAX_REC_AUX_GRANULES * VAL_MAX_REC_COUNT];
+    uint64_t rec_aux_slots;
+    uint64_t *rec_aux_granules;
     val_host_realm_state_te state;
 } val_host_realm_ts;
 
+typedef struct {
+    uint64_t magic;
+    uint64_t load_size;
+    uint64_t image_size;
+} val_host_realm_image_header_ts;
+
 typedef struct {
     /* Flags */
     SET_MEMBER_RMI(unsigned long flags, 0, 0x8);                /* Offset 0 */
@@ -410,15 +425,16 @@ typedef struct {
 
 typedef struct val_host_granule_ts {
     uint64_t rd;
-    uint32_t state;
     uint64_t PA;
     uint64_t ipa;
     uint64_t level;
     uint64_t rtt_tree_idx;
+    uint32_t state;
     uint8_t  is_granule_sliced;
     uint8_t has_auxiliary[VAL_MAX_AUX_PLANES];
     struct val_host_granule_ts *next;
-} val_host_granule_ts;
+    struct val_host_granule_ts *prev;
+} __aligned(CACHE_WRITEBACK_GRANULE) val_host_granule_ts;
 
 typedef struct {
     uint64_t src_pa;
@@ -428,36 +444,82 @@ typedef struct {
     uint64_t size;
 } val_data_create_ts;
 
-typedef val_host_granule_ts NS_LL;
-typedef val_host_granule_ts RD_LL;
-typedef val_host_granule_ts RTT_LL;
-typedef val_host_granule_ts RTT_AUX_LL;
-typedef val_host_granule_ts REC_LL;
-typedef val_host_granule_ts DATA_LL;
-typedef val_host_granule_ts VALID_NS_LL;
+/* Doubly linked list of granule nodes. DATA and unprotected lists also keep
+ * a radix tree of their nodes keyed by IPA. */
+typedef struct {
+    val_host_granule_ts *head;
+    val_host_granule_ts *tail;
+    uint64_t count;
+    bool ipa_indexed;
+    void *ipa_root;
+} val_host_granule_list_ts;
 
 typedef struct {
-    NS_LL *ns;
-    RD_LL *rd;
-    RTT_LL *rtt;
-    RTT_AUX_LL *rtt_aux;
-    REC_LL *rec;
-    DATA_LL *data;
-    VALID_NS_LL *valid_ns;
+    val_host_granule_list_ts ns;
+    val_host_granule_list_ts rd;
+    val_host_granule_list_ts rtt;
+    val_host_granule_list_ts rtt_aux;
+    val_host_granule_list_ts rec;
+    val_host_granule_list_ts data;
+    val_host_granule_list_ts valid_ns;
 } val_host_granule_type_ts;
 
 typedef struct mem_track {
     uint64_t rd;
+    bool in_use;
+    uint32_t next_free;
+    uint64_t ipa_width;
+    uint64_t rtt_level_start;
+    /* Shadow of the RTT tree, not used once an update failed */
+    void **rtt_shadow;
+    bool rtt_shadow_lost;
+    /* A checked shadow lookup disagreed with RTT_READ_ENTRY */
+    bool rtt_shadow_mismatch;
     val_host_granule_type_ts gran_type;
 } val_host_memory_track_ts;
 
-extern val_host_memory_track_ts mem_track[];
+typedef enum {
+    /* Unmap from the tracking lists, then destroy RTTs one level at a time */
+    VAL_HOST_TEARDOWN_LISTS = 0,
+    /* Walk each RTT tree once, depth first */
+    VAL_HOST_TEARDOWN_RTT_WALK
+} val_host_teardown_mode_te;
+
+typedef enum {
+    /* Map protected memory with page entries */
+    VAL_HOST_MAP_PAGES = 0,
+    /* Fold 2MB aligned regions of protected memory into L2 block entries */
+    VAL_HOST_MAP_L2_BLOCKS
+} val_host_map_mode_te;
+
+typedef enum {
+    /* Destroy the realms one after the other on the primary cpu */
+    VAL_HOST_POSTAMBLE_SERIAL = 0,
+    /* Share the teardown with the secondary cpus */
+    VAL_HOST_POSTAMBLE_PARALLEL
+} val_host_postamble_mode_te;
+
+typedef enum {
+    /* Populate protected memory on the calling cpu */
+    VAL_HOST_POPULATE_SERIAL = 0,
+    /* Share the population of large ranges with the secondary cpus */
+    VAL_HOST_POPULATE_PARALLEL
+} val_host_populate_mode_te;
+
+/* mem_track[0] is the NS list, realms use the slots from 1 up */
+extern val_host_memory_track_ts *mem_track;
 
 uint32_t val_host_map_protected_data(val_host_realm_ts *realm,
                 uint64_t target_pa,
                 uint64_t ipa,
                 uint64_t map_size,
                 uint64_t src_pa);
+uint32_t val_host_map_protected_data_range(val_host_realm_ts *realm,
+                uint64_t target_pa,
+                uint64_t base,
+                uint64_t top,
+                uint64_t src_pa,
+                uint64_t rtt_alignment);
 uint32_t val_host_map_protected_data_unknown(val_host_realm_ts *realm,
                         uint64_t target_pa,
                         uint64_t ipa,
@@ -475,10 +537,20 @@ uint32_t val_host_map_unprotected_attr(val_host_realm_ts *realm,
                         uint64_t mem_attr);
 
 uint32_t val_host_realm_create(val_host_realm_ts *realm);
+uint32_t val_host_realm_storage_alloc(val_host_realm_ts *realm);
+void val_host_realm_storage_free(val_host_realm_ts *realm);
+uint32_t val_host_realm_rec_storage_reserve(val_host_realm_ts *realm, uint64_t rec_count,
+                                            uint64_t aux_count);
+uint32_t val_host_realm_granule_add(val_host_realm_ts *realm, uint64_t ipa,
+                                    uint64_t size, uint64_t pa);
+void val_host_realm_params_reset(val_host_realm_params_ts *params);
+void val_host_rec_params_reset(val_host_rec_params_ts *params);
 uint32_t val_host_realm_rtt_map(val_host_realm_ts *realm);
 uint32_t val_host_rec_create(val_host_realm_ts *realm);
 uint32_t val_host_realm_activate(val_host_realm_ts *realm);
 uint32_t val_host_realm_destroy(uint64_t rd);
+void val_host_realm_teardown_mode_set(val_host_teardown_mode_te mode);
+void val_host_track_realm_params(uint64_t rd, uint64_t ipa_width, uint64_t rtt_level_start);
 uint32_t val_host_realm_setup(val_host_realm_ts *realm, bool activate);
 uint32_t val_host_check_realm_exit_host_call(val_host_rec_run_ts *run);
 uint32_t val_host_check_realm_exit_ripas_change(val_host_rec_run_ts *run);
@@ -492,11 +564,21 @@ void val_host_update_granule_state(uint64_t rd,
                         uint64_t level,
                         uint64_t rtt_tree_idx);
 uint64_t val_host_postamble(void);
-val_host_granule_ts *val_host_remove_granule(val_host_granule_ts **current, uint64_t PA);
-val_host_granule_ts *val_host_remove_data_granule(val_host_granule_ts **current, uint64_t ipa);
-val_host_granule_ts *val_host_remove_rtt_granule(val_host_granule_ts **gran_list_head,
+void val_host_postamble_mode_set(val_host_postamble_mode_te mode);
+bool val_host_mp_worker_pending(void);
+void val_host_mp_worker(void);
+void val_host_populate_mode_set(val_host_populate_mode_te mode);
+val_host_populate_mode_te val_host_populate_mode_get(void);
+uint32_t val_host_map_protected_data_parallel(val_host_realm_ts *realm,
+                                              val_data_create_ts *data_create);
+val_host_granule_ts *val_host_remove_granule(val_host_granule_list_ts *gran_list, uint64_t PA);
+val_host_granule_ts *val_host_find_ipa_granule(val_host_granule_list_ts *gran_list, uint64_t ipa);
+val_host_granule_ts *val_host_next_ipa_granule(val_host_granule_list_ts *gran_list, uint64_t ipa);
+uint32_t val_host_realm_unmap_range(uint64_t rd, uint64_t base, uint64_t top);
+val_host_granule_ts *val_host_remove_data_granule(val_host_granule_list_ts *gran_list, uint64_t ipa);
+val_host_granule_ts *val_host_remove_rtt_granule(val_host_granule_list_ts *gran_list,
                                                         uint64_t ipa, uint64_t level);
-val_host_granule_ts *val_host_remove_aux_rtt_granule(val_host_granule_ts **gran_list_head,
+val_host_granule_ts *val_host_remove_aux_rtt_granule(val_host_granule_list_ts *gran_list,
                                                    uint64_t ipa, uint64_t level, uint64_t index);
 int val_host_get_curr_realm(uint64_t rd);
 void val_host_update_destroy_granule_state(uint64_t rd,
@@ -516,6 +598,18 @@ uint32_t val_host_create_rtt_levels(val_host_realm_ts *realm,
                    uint64_t max_level,
                    uint64_t rtt_alignment);
 
+void val_host_map_mode_set(val_host_map_mode_te mode);
+void val_host_update_data_map_level(uint64_t rd, uint64_t base, uint64_t top, uint64_t level);
+uint32_t val_host_rtt_shadow_level(uint64_t rd, uint64_t ipa, uint64_t level,
+                                   uint64_t *walk_level);
+void val_host_rtt_shadow_check_set(bool enable);
+bool val_host_rtt_shadow_mismatch(uint64_t rd);
+uint32_t val_host_create_rtt_range(val_host_realm_ts *realm,
+                   uint64_t base,
+                   uint64_t top,
+                   uint64_t rtt_max_level,
+                   uint64_t rtt_alignment);
+
 uint32_t val_host_map_protected_data_to_realm(val_host_realm_ts *realm,
                                             val_data_create_ts *data_create);
 
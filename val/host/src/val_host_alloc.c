@@ -8,15 +8,97 @@
 #include "val_host_alloc.h"
 #include "val_host_realm.h"
 
+/* The heap is managed as an array of granules. Every granule has one bit in
+ * page_bitmap (1 = in use) and one byte in page_type describing how it is used.
+ * Allocations of at least a granule are served as contiguous runs of granules,
+ * smaller allocations are carved out of slab granules by size class.
+ * The top PLATFORM_HEAP_BLOCK_REGION_SIZE of the heap forms a separate zone which
+ * is preferred by allocations aligned to VAL_RTT_L2_BLOCK_SIZE or more, so that block
+ * mappings find physically contiguous aligned memory. Either zone serves the
+ * allocations of the other one once it is exhausted. */
+#define VAL_HOST_HEAP_PAGES       (PLATFORM_HEAP_REGION_SIZE / PAGE_SIZE)
+#define VAL_HOST_HEAP_WORDS       ((VAL_HOST_HEAP_PAGES + 63) / 64)
+#define VAL_HOST_INVALID_PAGE     (~0ULL)
+
+#define VAL_HOST_HEAP_TOP         (PLATFORM_HEAP_REGION_BASE + PLATFORM_HEAP_REGION_SIZE)
+#define VAL_HOST_BLOCK_ZONE_BASE  ADDR_ALIGN(VAL_HOST_HEAP_TOP - PLATFORM_HEAP_BLOCK_REGION_SIZE, \
+                                             VAL_RTT_L2_BLOCK_SIZE)
+
+#define VAL_HOST_MIN_CLASS_SHIFT  6
+#define VAL_HOST_NUM_CLASSES      6
+#define VAL_HOST_MAX_CLASS_SIZE   (1UL << (VAL_HOST_MIN_CLASS_SHIFT + VAL_HOST_NUM_CLASSES - 1))
+
+/* Delegated granule pool. Granules released by realm teardown are kept delegated
+ * up to VAL_HOST_GRANULE_POOL_SIZE and handed out again to the realm helpers, so that
+ * RD/RTT/REC creation doesn't need a GRANULE_DELEGATE and teardown doesn't need a
+ * GRANULE_UNDELEGATE for each of them. The pool survives the per test heap reset. */
+#define VAL_HOST_GRANULE_POOL_SIZE    512
+#define VAL_HOST_GRANULE_POOL_REFILL  16
+
+/* Each PE serves single granule and small object allocations from its own arena
+ * without taking heap_lock. An empty arena takes VAL_HOST_ARENA_PAGES granules
+ * from the global heap at once. */
+#define VAL_HOST_ARENA_PAGES          32
+
+/* page_tag value of granules which are not accounted to any purpose */
+#define VAL_HOST_MEM_TAG_NONE         VAL_HOST_MEM_TAG_COUNT
+
+typedef enum {
+    PAGE_FREE = 0,
+    PAGE_HEAD,      /* First granule of an allocation */
+    PAGE_BODY,      /* Continuation granule of an allocation */
+    PAGE_POOL,      /* Delegated granule held by the granule pool */
+    PAGE_ARENA,     /* Granule cached in a PE arena */
+    PAGE_SLAB       /* PAGE_SLAB + n: granule carved into objects of size class n */
+} val_host_page_type_te;
+
+typedef struct val_host_free_obj {
+    struct val_host_free_obj *next;
+} val_host_free_obj_ts;
+
+typedef struct {
+    uint64_t pages[VAL_HOST_ARENA_PAGES];
+    uint32_t page_next;
+    uint32_t page_count;
+    val_host_free_obj_ts *class_free_list[VAL_HOST_NUM_CLASSES];
+    /* Page for RMI input structures, zero whenever it is not in use */
+    uint64_t scratch_page;
+} __aligned(CACHE_WRITEBACK_GRANULE) val_host_arena_ts;
+
 typedef struct {
-    uint64_t base;
-    uint64_t size;
-} val_host_alloc_region_ts;
+    uint64_t first;         /* First page of the zone */
+    uint64_t end;           /* Page following the zone */
+    uint64_t next_fit;      /* Page to resume the search from */
+} val_host_zone_ts;
 
-static int number_of_regions;
+/* Global heap state, protected by heap_lock */
+static s_lock_t heap_lock;
+static uint64_t page_bitmap[VAL_HOST_HEAP_WORDS];
+static uint8_t page_type[VAL_HOST_HEAP_PAGES];
+static uint8_t page_tag[VAL_HOST_HEAP_PAGES];
+static uint64_t free_pages;
+static uint64_t used_pages_peak;
+/* Granules accounted per purpose and their peak in the current test */
+static int64_t tag_pages[VAL_HOST_MEM_TAG_COUNT];
+static int64_t tag_peak[VAL_HOST_MEM_TAG_COUNT];
+static val_host_zone_ts granule_zone;
+static val_host_zone_ts block_zone;
+
+/* Per PE state, only accessed by the owning PE */
+static val_host_arena_ts arena[PLATFORM_CPU_COUNT];
+
+static uint64_t granule_pool[VAL_HOST_GRANULE_POOL_SIZE];
+static uint32_t granule_pool_count;
+
+/* Usage peaks over all tests of the run */
+static uint64_t run_used_pages_peak;
+static int64_t run_tag_peak[VAL_HOST_MEM_TAG_COUNT];
+
+static const char *const mem_tag_name[VAL_HOST_MEM_TAG_COUNT] = {
+    "Other", "RD", "RTT", "Aux RTT", "REC", "REC aux", "DATA",
+    "Run objects", "Params", "Tracking nodes", "Realm objects", "Granule pool"
+};
 
-static uint64_t heap_base;
-static uint64_t heap_top;
 static uint16_t curr_vmid;
 
 /* get vmid */
@@ -26,47 +108,368 @@ uint16_t val_host_get_vmid(void)
     return curr_vmid;
 }
 
-static int val_is_power_of_2(uint32_t n)
+static int val_is_power_of_2(uint64_t n)
 {
     return n && !(n & (n - 1));
 }
 
+static inline uint64_t val_host_page_to_addr(uint64_t page)
+{
+    return PLATFORM_HEAP_REGION_BASE + (page * PAGE_SIZE);
+}
+
+static inline uint64_t val_host_addr_to_page(uint64_t addr)
+{
+    return (addr - PLATFORM_HEAP_REGION_BASE) / PAGE_SIZE;
+}
+
+static inline bool val_host_addr_in_heap(uint64_t addr)
+{
+    return (addr >= PLATFORM_HEAP_REGION_BASE) &&
+           (addr < (PLATFORM_HEAP_REGION_BASE + PLATFORM_HEAP_REGION_SIZE));
+}
+
+/* Round page index up so that its address meets the alignment */
+static inline uint64_t val_host_page_align(uint64_t page, uint64_t alignment)
+{
+    return val_host_addr_to_page(ADDR_ALIGN(val_host_page_to_addr(page), alignment));
+}
+
+/* Return first in-use page within [start, end), or end if none */
+static uint64_t val_host_find_used_page(uint64_t start, uint64_t end)
+{
+    uint64_t word;
+
+    while (start < end)
+    {
+        word = page_bitmap[start / 64] >> (start % 64);
+        if (word)
+        {
+            start += (uint64_t)__builtin_ctzll(word);
+            return (start < end) ? start : end;
+        }
+        start = (start | 63) + 1;
+    }
+
+    return end;
+}
+
+/* Return first free page within [start, end), or end if none */
+static uint64_t val_host_find_free_page(uint64_t start, uint64_t end)
+{
+    uint64_t word;
+
+    while (start < end)
+    {
+        word = (~page_bitmap[start / 64]) >> (start % 64);
+        if (word)
+        {
+            start += (uint64_t)__builtin_ctzll(word);
+            return (start < end) ? start : end;
+        }
+        start = (start | 63) + 1;
+    }
+
+    return end;
+}
+
+static void val_host_mark_pages(uint64_t page, uint64_t count, bool used)
+{
+    uint64_t i;
+
+    for (i = page; i < page + count; i++)
+    {
+        if (used)
+            page_bitmap[i / 64] |= (1ULL << (i % 64));
+        else
+            page_bitmap[i / 64] &= ~(1ULL << (i % 64));
+    }
+}
+
+/* Search [start, end) for a run of free pages with the requested alignment */
+static uint64_t val_host_page_search(uint64_t start, uint64_t end,
+                                     uint64_t count, uint64_t alignment)
+{
+    uint64_t page, used;
+
+    page = val_host_page_align(val_host_find_free_page(start, end), alignment);
+    while (page + count <= end)
+    {
+        used = val_host_find_used_page(page, page + count);
+        if (used == page + count)
+            return page;
+
+        page = val_host_page_align(val_host_find_free_page(used + 1, end), alignment);
+    }
+
+    return VAL_HOST_INVALID_PAGE;
+}
+
 /**
- * @brief Allocates contiguous memory of requested size(no_of_bytes) and alignment.
- * @param alignment - alignment for the address. It must be in power of 2.
- * @param Size - Size of the region. It must not be zero.
- * @return - Returns allocated memory base address if allocation is successful.
- *           Otherwise returns NULL.
+ * @brief Allocates a run of contiguous granules from a zone. The search resumes
+ *        from where the previous allocation ended so that freed granules are not
+ *        handed out again straight away.
+ * @param zone - Heap zone to allocate from
+ * @param count - Number of granules
+ * @param alignment - Alignment of the first granule address
+ * @return - Returns base address of the run on success, otherwise 0.
  **/
-void *mem_alloc(size_t alignment, size_t size)
+static uint64_t val_host_page_alloc(val_host_zone_ts *zone, uint64_t count, uint64_t alignment)
+{
+    uint64_t page;
+
+    if (count > free_pages)
+        return 0;
+
+    page = val_host_page_search(zone->next_fit, zone->end, count, alignment);
+    if (page == VAL_HOST_INVALID_PAGE)
+        page = val_host_page_search(zone->first, zone->end, count, alignment);
+    if (page == VAL_HOST_INVALID_PAGE)
+        return 0;
+
+    val_host_mark_pages(page, count, true);
+    page_type[page] = PAGE_HEAD;
+    val_memset(&page_type[page + 1], PAGE_BODY, count - 1);
+    free_pages -= count;
+    zone->next_fit = page + count;
+
+    if (VAL_HOST_HEAP_PAGES - free_pages > used_pages_peak)
+        used_pages_peak = VAL_HOST_HEAP_PAGES - free_pages;
+
+    return val_host_page_to_addr(page);
+}
+
+/**
+ * @brief Allocates a run of contiguous granules from the zone matching the
+ *        alignment, or from the other zone when that one is exhausted.
+ * @param count - Number of granules
+ * @param alignment - Alignment of the first granule address
+ * @return - Returns base address of the run on success, otherwise 0.
+ **/
+static uint64_t val_host_zone_page_alloc(uint64_t count, uint64_t alignment)
+{
+    val_host_zone_ts *zone = &granule_zone, *fallback = &block_zone;
+    uint64_t addr;
+
+    if (alignment >= VAL_RTT_L2_BLOCK_SIZE)
+    {
+        zone = &block_zone;
+        fallback = &granule_zone;
+    }
+
+    addr = val_host_page_alloc(zone, count, alignment);
+    if (!addr)
+        addr = val_host_page_alloc(fallback, count, alignment);
+
+    return addr;
+}
+
+static inline val_host_arena_ts *val_host_get_arena(void)
+{
+    return &arena[val_get_cpuid(val_read_mpidr())];
+}
+
+/* Account granules to a purpose, VAL_HOST_MEM_TAG_NONE drops them from accounting.
+ * Called with heap_lock held. */
+static void val_host_account_pages(uint64_t page, uint64_t count, uint32_t tag)
+{
+    uint64_t i;
+
+    for (i = page; i < page + count; i++)
+    {
+        if (page_tag[i] != VAL_HOST_MEM_TAG_NONE)
+            tag_pages[page_tag[i]]--;
+        page_tag[i] = (uint8_t)tag;
+    }
+
+    if (tag != VAL_HOST_MEM_TAG_NONE)
+    {
+        tag_pages[tag] += (int64_t)count;
+        if (tag_pages[tag] > tag_peak[tag])
+            tag_peak[tag] = tag_pages[tag];
+    }
+}
+
+static void val_host_page_free(uint64_t page, uint64_t count)
+{
+    val_host_account_pages(page, count, VAL_HOST_MEM_TAG_NONE);
+    val_host_mark_pages(page, count, false);
+    val_memset(&page_type[page], PAGE_FREE, count);
+    free_pages += count;
+
+    /* Remaining part of the allocation becomes an allocation on its own */
+    if ((page + count < VAL_HOST_HEAP_PAGES) && (page_type[page + count] == PAGE_BODY))
+        page_type[page + count] = PAGE_HEAD;
+}
+
+static uint64_t val_host_arena_page_alloc(val_host_arena_ts *cpu_arena, uint32_t tag)
 {
     uint64_t addr;
 
-    addr = ADDR_ALIGN(heap_base, alignment);
-    size += addr - heap_base;
+    if (cpu_arena->page_next == cpu_arena->page_count)
+    {
+        cpu_arena->page_next = 0;
+        cpu_arena->page_count = 0;
+
+        val_spin_lock(&heap_lock);
+        while (cpu_arena->page_count < VAL_HOST_ARENA_PAGES)
+        {
+            addr = val_host_zone_page_alloc(1, PAGE_SIZE);
+            if (!addr)
+                break;
+
+            page_type[val_host_addr_to_page(addr)] = PAGE_ARENA;
+            cpu_arena->pages[cpu_arena->page_count++] = addr;
+        }
+        val_spin_unlock(&heap_lock);
+
+        if (cpu_arena->page_count == 0)
+            return 0;
+    }
+
+    addr = cpu_arena->pages[cpu_arena->page_next++];
+    page_type[val_host_addr_to_page(addr)] = PAGE_HEAD;
+
+    val_spin_lock(&heap_lock);
+    val_host_account_pages(val_host_addr_to_page(addr), 1, tag);
+    val_spin_unlock(&heap_lock);
+
+    return addr;
+}
+
+static uint32_t val_host_size_class(size_t alignment, size_t size)
+{
+    uint32_t class = 0;
+
+    if (alignment > size)
+        size = alignment;
+
+    while ((1UL << (class + VAL_HOST_MIN_CLASS_SHIFT)) < size)
+        class++;
+
+    return class;
+}
 
-    if ((heap_top - heap_base) < size)
+static void *val_host_obj_alloc(val_host_arena_ts *cpu_arena, uint32_t class, uint32_t tag)
+{
+    val_host_free_obj_ts *obj;
+    uint64_t page, obj_size = 1UL << (class + VAL_HOST_MIN_CLASS_SHIFT);
+    uint64_t offset;
+
+    if (cpu_arena->class_free_list[class] == NULL)
+    {
+        page = val_host_arena_page_alloc(cpu_arena, tag);
+        if (!page)
+            return NULL;
+
+        page_type[val_host_addr_to_page(page)] = (uint8_t)(PAGE_SLAB + class);
+
+        /* Thread the new slab on the free list in address order */
+        for (offset = PAGE_SIZE; offset != 0; offset -= obj_size)
+        {
+            obj = (val_host_free_obj_ts *)(page + offset - obj_size);
+            obj->next = cpu_arena->class_free_list[class];
+            cpu_arena->class_free_list[class] = obj;
+        }
+    }
+
+    obj = cpu_arena->class_free_list[class];
+    cpu_arena->class_free_list[class] = obj->next;
+
+    return (void *)obj;
+}
+
+static void *val_host_alloc_common(size_t alignment, size_t size, uint32_t tag)
+{
+    void *addr;
+    uint64_t page;
+
+    if (alignment == 0)
+        alignment = 1;
+
+    while (!val_is_power_of_2(alignment))
+        alignment = (alignment | (alignment - 1)) + 1;
+
+    if ((size <= VAL_HOST_MAX_CLASS_SIZE) && (alignment <= VAL_HOST_MAX_CLASS_SIZE))
+        addr = val_host_obj_alloc(val_host_get_arena(), val_host_size_class(alignment, size), tag);
+    else if ((size <= PAGE_SIZE) && (alignment <= PAGE_SIZE))
+        addr = (void *)val_host_arena_page_alloc(val_host_get_arena(), tag);
+    else
+    {
+        val_spin_lock(&heap_lock);
+        addr = (void *)val_host_zone_page_alloc(ADDR_ALIGN(size, PAGE_SIZE) / PAGE_SIZE,
+                                                (alignment < PAGE_SIZE) ? PAGE_SIZE : alignment);
+        if (addr != NULL)
+        {
+            page = val_host_addr_to_page((uint64_t)addr);
+            val_host_account_pages(page, ADDR_ALIGN(size, PAGE_SIZE) / PAGE_SIZE, tag);
+        }
+        val_spin_unlock(&heap_lock);
+    }
+
+    if (addr == NULL)
     {
        LOG(ERROR, "Not enough space available\n");
        return NULL;
     }
 
-    heap_base += size;
+    return addr;
+}
 
-    return (void *)addr;
+/**
+ * @brief Allocates contiguous memory of requested size(no_of_bytes) and alignment.
+ * @param alignment - alignment for the address. A value which is not power of 2
+ *                    is rounded up to the next power of 2.
+ * @param Size - Size of the region. It must not be zero.
+ * @return - Returns allocated memory base address if allocation is successful.
+ *           Otherwise returns NULL.
+ **/
+void *mem_alloc(size_t alignment, size_t size)
+{
+    return val_host_alloc_common(alignment, size, VAL_HOST_MEM_TAG_OTHER);
 }
 
 /**
- * @brief  Initialisation of allocation data structure
+ * @brief  Initialisation of allocation data structure. Granules held by the
+ *         granule pool stay delegated across tests, so they are reserved again
+ *         and added back to the NS mem_track, which must have been reset before.
  * @param  void
  * @return Void
  **/
 void val_host_mem_alloc_init(void)
 {
-    heap_base = PLATFORM_HEAP_REGION_BASE;
-    heap_top = PLATFORM_HEAP_REGION_BASE + PLATFORM_HEAP_REGION_SIZE;
-    number_of_regions = 0;
+    uint64_t page;
+    uint32_t i;
+
+    val_init_spinlock(&heap_lock);
+    val_memset(page_bitmap, 0, sizeof(page_bitmap));
+    val_memset(page_type, PAGE_FREE, sizeof(page_type));
+    val_memset(page_tag, VAL_HOST_MEM_TAG_NONE, sizeof(page_tag));
+    val_memset(arena, 0, sizeof(arena));
+    val_memset(tag_pages, 0, sizeof(tag_pages));
+    val_memset(tag_peak, 0, sizeof(tag_peak));
+    free_pages = VAL_HOST_HEAP_PAGES;
+
+    block_zone.first = val_host_addr_to_page(VAL_HOST_BLOCK_ZONE_BASE);
+    block_zone.end = VAL_HOST_HEAP_PAGES;
+    block_zone.next_fit = block_zone.first;
+    granule_zone.first = 0;
+    granule_zone.end = block_zone.first;
+    granule_zone.next_fit = 0;
     curr_vmid = 0;
+
+    for (i = 0; i < granule_pool_count; i++)
+    {
+        page = val_host_addr_to_page(granule_pool[i]);
+        val_host_mark_pages(page, 1, true);
+        page_type[page] = PAGE_POOL;
+        val_host_account_pages(page, 1, VAL_HOST_MEM_TAG_POOL);
+        free_pages--;
+    }
+    used_pages_peak = VAL_HOST_HEAP_PAGES - free_pages;
+
+    for (i = 0; i < granule_pool_count; i++)
+        val_host_add_granule(GRANULE_DELEGATED, granule_pool[i], NULL);
 }
 
 /**
@@ -78,36 +481,427 @@ void val_host_mem_alloc_init(void)
  **/
 void *val_host_mem_alloc(size_t alignment, size_t size)
 {
-  void *addr = NULL;
-
   if (size <= 0)
   {
     LOG(ERROR, "size must be non-zero value\n");
     return NULL;
   }
 
-  if (!val_is_power_of_2((uint32_t)alignment))
+  if (!val_is_power_of_2(alignment))
   {
     LOG(ERROR, "Alignment must be power of 2\n");
     return NULL;
   }
 
-  size += alignment - 1;
-  addr = mem_alloc(alignment, size);
+  return val_host_alloc_common(alignment, size, VAL_HOST_MEM_TAG_OTHER);
+}
+
+/**
+ * @brief Allocates memory like val_host_mem_alloc and accounts it to a purpose
+ *        in the heap usage report.
+ * @param alignment - alignment for the address. It must be in power of 2.
+ * @param size - Size of the region. It must not be zero.
+ * @param tag - Purpose of the allocation
+ * @return - Returns allocated memory base address if allocation is successful.
+ *           Otherwise returns NULL.
+ **/
+void *val_host_mem_alloc_tag(size_t alignment, size_t size, val_host_mem_tag_te tag)
+{
+    if (size == 0 || !val_is_power_of_2(alignment) || tag >= VAL_HOST_MEM_TAG_COUNT)
+    {
+        LOG(ERROR, "Invalid allocation request, size=0x%x tag=%d\n", size, tag);
+        return NULL;
+    }
 
-  return addr;
+    return val_host_alloc_common(alignment, size, tag);
 }
 
 /**
- * Free the memory for given memory address
- * Currently acs code is initialisazing from base for every test,
- * the regions data structure is internal and below code only setting to zero
- * not actually freeing memory.
+ * @brief Get the scratch page of the current PE for building RMI input
+ *        structures. The page is zero when handed out and is reused by the next
+ *        caller on the same PE, so the caller must clear the fields it wrote
+ *        once the RMI call has consumed them. The page is released along with
+ *        the rest of the heap at the start of the next test.
+ * @param void
+ * @return - Returns scratch page address on success, otherwise NULL.
+ **/
+void *val_host_scratch_page_get(void)
+{
+    val_host_arena_ts *cpu_arena = val_host_get_arena();
+
+    if (!cpu_arena->scratch_page)
+    {
+        cpu_arena->scratch_page = (uint64_t)val_host_alloc_common(PAGE_SIZE, PAGE_SIZE,
+                                                                 VAL_HOST_MEM_TAG_PARAMS);
+        if (!cpu_arena->scratch_page)
+            return NULL;
+
+        val_memset((void *)cpu_arena->scratch_page, 0, PAGE_SIZE);
+    }
+
+    return (void *)cpu_arena->scratch_page;
+}
+
+/**
+ * @brief Re-account the granule containing addr to another purpose, e.g. when
+ *        a delegated granule is turned into a realm object. Granules shared by
+ *        small objects keep the purpose they were allocated for.
+ * @param addr - Address within the granule
+ * @param tag - New purpose of the granule
+ * @return void
+ **/
+void val_host_mem_set_tag(uint64_t addr, val_host_mem_tag_te tag)
+{
+    uint64_t page;
+
+    if (!val_host_addr_in_heap(addr) || tag >= VAL_HOST_MEM_TAG_COUNT)
+        return;
+
+    page = val_host_addr_to_page(addr);
+
+    val_spin_lock(&heap_lock);
+    if (page_type[page] == PAGE_HEAD || page_type[page] == PAGE_BODY)
+        val_host_account_pages(page, 1, tag);
+    val_spin_unlock(&heap_lock);
+}
+
+/**
+ * @brief Allocates physically contiguous memory, preferably from the block zone,
+ *        aligned to a block size so that it can be mapped with block level RTT entries.
+ * @param block_size - VAL_RTT_L2_BLOCK_SIZE or VAL_RTT_L1_BLOCK_SIZE
+ * @param size - Size of the region, rounded up to a multiple of block_size
+ * @return - Returns allocated memory base address if allocation is successful.
+ *           Otherwise returns NULL.
+ **/
+void *val_host_mem_alloc_block(size_t block_size, size_t size)
+{
+    uint64_t addr;
+
+    if ((block_size != VAL_RTT_L2_BLOCK_SIZE) && (block_size != VAL_RTT_L1_BLOCK_SIZE))
+    {
+        LOG(ERROR, "Unsupported block size=0x%x\n", block_size);
+        return NULL;
+    }
+
+    if (size == 0)
+    {
+        LOG(ERROR, "size must be non-zero value\n");
+        return NULL;
+    }
+
+    val_spin_lock(&heap_lock);
+    addr = val_host_zone_page_alloc(ADDR_ALIGN(size, block_size) / PAGE_SIZE, block_size);
+    if (addr)
+        val_host_account_pages(val_host_addr_to_page(addr), ADDR_ALIGN(size, block_size) / PAGE_SIZE,
+                               VAL_HOST_MEM_TAG_OTHER);
+    val_spin_unlock(&heap_lock);
+
+    if (!addr)
+    {
+        LOG(ERROR, "No free block of size=0x%x in heap\n", ADDR_ALIGN(size, block_size));
+        return NULL;
+    }
+
+    return (void *)addr;
+}
+
+/**
+ * @brief Free the memory for given memory address. For granule allocations
+ *        the granule containing ptr and the rest of its allocation are freed.
+ *        Freeing an address which is not allocated is ignored.
+ * @param ptr - Address returned by val_host_mem_alloc
+ * @return void
  **/
 void val_host_mem_free(void *ptr)
 {
-  if (!ptr)
-    return;
+    uint64_t page, end;
+
+    if (!ptr || !val_host_addr_in_heap((uint64_t)ptr))
+        return;
+
+    page = val_host_addr_to_page((uint64_t)ptr);
+
+    /* Small objects go to the free list of the freeing PE */
+    if (page_type[page] >= PAGE_SLAB)
+    {
+        val_host_arena_ts *cpu_arena = val_host_get_arena();
+        val_host_free_obj_ts *obj = ptr;
+        uint32_t class = (uint32_t)(page_type[page] - PAGE_SLAB);
+
+        obj->next = cpu_arena->class_free_list[class];
+        cpu_arena->class_free_list[class] = obj;
+        return;
+    }
+
+    val_spin_lock(&heap_lock);
+    if (page_type[page] == PAGE_HEAD || page_type[page] == PAGE_BODY)
+    {
+        for (end = page + 1; end < VAL_HOST_HEAP_PAGES && page_type[end] == PAGE_BODY; end++)
+            ;
+
+        val_host_page_free(page, end - page);
+    }
+    val_spin_unlock(&heap_lock);
+}
+
+/**
+ * @brief Free a single granule of an allocation, leaving rest of the allocation
+ *        in place. Used when individual granules of a larger allocation are
+ *        undelegated and released one at a time.
+ * @param addr - Address of the granule
+ * @return void
+ **/
+void val_host_mem_free_granule(uint64_t addr)
+{
+    uint64_t page;
+
+    if (!val_host_addr_in_heap(addr))
+        return;
+
+    page = val_host_addr_to_page(addr);
+
+    val_spin_lock(&heap_lock);
+    if (page_type[page] == PAGE_HEAD || page_type[page] == PAGE_BODY)
+        val_host_page_free(page, 1);
+    val_spin_unlock(&heap_lock);
+}
+
+/**
+ * @brief Number of heap granules in use, including slab granules
+ * @param void
+ * @return Returns the number of granules in use
+ **/
+uint64_t val_host_mem_used_pages(void)
+{
+    return VAL_HOST_HEAP_PAGES - free_pages;
+}
+
+/**
+ * @brief Delegate a batch of granules into the granule pool
+ * @param void
+ * @return Returns VAL_SUCCESS if at least one granule was added, otherwise VAL_ERROR.
+ **/
+static uint32_t val_host_granule_pool_refill(void)
+{
+    uint64_t addr[VAL_HOST_GRANULE_POOL_REFILL];
+    uint32_t i, count = 0, delegated = 0, status = VAL_SUCCESS;
+
+    val_spin_lock(&heap_lock);
+    while (count < VAL_HOST_GRANULE_POOL_REFILL)
+    {
+        addr[count] = val_host_page_alloc(&granule_zone, 1, PAGE_SIZE);
+        if (!addr[count])
+            break;
+        count++;
+    }
+    val_spin_unlock(&heap_lock);
+
+    /* Delegation updates mem_track, so it's done outside of heap_lock */
+    for (i = 0; i < count; i++)
+    {
+        if (val_host_rmi_granule_delegate(addr[i]))
+        {
+            LOG(ERROR, "Granule delegation failed, PA=0x%x\n", addr[i]);
+            break;
+        }
+    }
+    delegated = i;
+
+    val_spin_lock(&heap_lock);
+    for (i = delegated; i < count; i++)
+        val_host_page_free(val_host_addr_to_page(addr[i]), 1);
+    val_spin_unlock(&heap_lock);
+
+    /* Another PE may have filled the pool meanwhile, granules which don't fit
+     * are undelegated and freed by val_host_granule_pool_put() */
+    for (i = 0; i < delegated; i++)
+    {
+        if (val_host_granule_pool_put(addr[i]))
+            status = VAL_ERROR;
+    }
+
+    return delegated ? status : VAL_ERROR;
+}
+
+/**
+ * @brief Get a delegated granule. Granules are taken from the granule pool
+ *        when the alignment allows it, otherwise a granule is allocated and
+ *        delegated. The granule is released with val_host_granule_pool_put()
+ *        while delegated, or with GRANULE_UNDELEGATE and val_host_mem_free().
+ * @param alignment - Alignment of the granule address
+ * @return - Returns delegated granule address on success, otherwise 0.
+ **/
+uint64_t val_host_granule_pool_get(size_t alignment)
+{
+    uint64_t addr = 0;
+
+    while (alignment <= PAGE_SIZE)
+    {
+        val_spin_lock(&heap_lock);
+        if (granule_pool_count)
+        {
+            addr = granule_pool[--granule_pool_count];
+            page_type[val_host_addr_to_page(addr)] = PAGE_HEAD;
+            val_host_account_pages(val_host_addr_to_page(addr), 1, VAL_HOST_MEM_TAG_OTHER);
+        }
+        val_spin_unlock(&heap_lock);
 
-  return;
+        if (addr)
+            return addr;
+
+        /* The pool only holds granule zone granules, once they are exhausted
+         * the granule is allocated from any zone and delegated below */
+        if (val_host_granule_pool_refill())
+            break;
+    }
+
+    addr = (uint64_t)val_host_mem_alloc(alignment, PAGE_SIZE);
+    if (!addr)
+        return 0;
+
+    if (val_host_rmi_granule_delegate(addr))
+    {
+        LOG(ERROR, "Granule delegation failed, PA=0x%x\n", addr);
+        val_host_mem_free((void *)addr);
+        return 0;
+    }
+
+    return addr;
+}
+
+/**
+ * @brief Return a delegated granule to the granule pool. The granule is split
+ *        from the allocation it belongs to. It is undelegated and freed instead
+ *        if the pool is full or the granule is not part of the heap.
+ * @param addr - Address of the delegated granule
+ * @return - Returns VAL_SUCCESS/VAL_ERROR
+ **/
+uint32_t val_host_granule_pool_put(uint64_t addr)
+{
+    uint64_t page = val_host_addr_to_page(addr);
+    uint64_t ret;
+    bool pooled = false;
+
+    val_spin_lock(&heap_lock);
+    if (val_host_addr_in_heap(addr) && page_type[page] == PAGE_POOL)
+    {
+        pooled = true;
+    } else if (val_host_addr_in_heap(addr) && page < granule_zone.end &&
+               page_type[page] < PAGE_ARENA && granule_pool_count < VAL_HOST_GRANULE_POOL_SIZE)
+    {
+        if (page_type[page] == PAGE_FREE)
+        {
+            val_host_mark_pages(page, 1, true);
+            free_pages--;
+        }
+
+        /* Split the granule from the allocation it belongs to */
+        if ((page + 1 < VAL_HOST_HEAP_PAGES) && (page_type[page + 1] == PAGE_BODY))
+            page_type[page + 1] = PAGE_HEAD;
+
+        page_type[page] = PAGE_POOL;
+        val_host_account_pages(page, 1, VAL_HOST_MEM_TAG_POOL);
+        granule_pool[granule_pool_count++] = addr;
+        pooled = true;
+    }
+    val_spin_unlock(&heap_lock);
+
+    if (pooled)
+        return VAL_SUCCESS;
+
+    ret = val_host_rmi_granule_undelegate(addr);
+    if (ret)
+    {
+        LOG(ERROR, "Granule undelegation failed, PA=0x%x, ret=0x%x\n", addr, ret);
+        return VAL_ERROR;
+    }
+    val_host_mem_free_granule(addr);
+
+    return VAL_SUCCESS;
+}
+
+/**
+ * @brief Undelegate and release granules from the granule pool until it holds
+ *        at most count granules. Shrinking to zero drains the pool.
+ * @param count - Number of granules to keep
+ * @return - Returns VAL_SUCCESS/VAL_ERROR
+ **/
+uint32_t val_host_granule_pool_shrink(uint32_t count)
+{
+    uint64_t addr, ret;
+
+    while (1)
+    {
+        val_spin_lock(&heap_lock);
+        if (granule_pool_count <= count)
+        {
+            val_spin_unlock(&heap_lock);
+            break;
+        }
+        addr = granule_pool[--granule_pool_count];
+        page_type[val_host_addr_to_page(addr)] = PAGE_HEAD;
+        val_spin_unlock(&heap_lock);
+
+        ret = val_host_rmi_granule_undelegate(addr);
+        if (ret)
+        {
+            LOG(ERROR, "Granule undelegation failed, PA=0x%x, ret=0x%x\n", addr, ret);
+            return VAL_ERROR;
+        }
+        val_host_mem_free_granule(addr);
+    }
+
+    return VAL_SUCCESS;
+}
+
+/**
+ * @brief Print heap usage of the test that just completed and fold it into the
+ *        usage figures of the run. Per purpose peaks are printed at INFO level.
+ * @param void
+ * @return void
+ **/
+void val_host_mem_usage_report(void)
+{
+    int64_t peak;
+    uint32_t tag;
+
+    LOG(ALWAYS, "\tHeap usage : peak %d KB of %d KB\n",
+                (used_pages_peak * PAGE_SIZE) / 1024, (VAL_HOST_HEAP_PAGES * PAGE_SIZE) / 1024);
+
+    for (tag = 0; tag < VAL_HOST_MEM_TAG_COUNT; tag++)
+    {
+        val_spin_lock(&heap_lock);
+        peak = tag_peak[tag];
+        val_spin_unlock(&heap_lock);
+
+        if (peak <= 0)
+            continue;
+
+        LOG(INFO, "\t  %s : peak %d KB\n", mem_tag_name[tag], (peak * PAGE_SIZE) / 1024);
+        if (peak > run_tag_peak[tag])
+            run_tag_peak[tag] = peak;
+    }
+
+    if (used_pages_peak > run_used_pages_peak)
+        run_used_pages_peak = used_pages_peak;
+}
+
+/**
+ * @brief Print the largest heap usage seen by any test of the run
+ * @param void
+ * @return void
+ **/
+void val_host_mem_usage_summary(void)
+{
+    uint32_t tag;
+
+    LOG(ALWAYS, "\n Heap usage across tests : peak %d KB of %d KB\n",
+                (run_used_pages_peak * PAGE_SIZE) / 1024, (VAL_HOST_HEAP_PAGES * PAGE_SIZE) / 1024);
+
+    for (tag = 0; tag < VAL_HOST_MEM_TAG_COUNT; tag++)
+    {
+        if (run_tag_peak[tag] > 0)
+            LOG(ALWAYS, "   %s : peak %d KB\n", mem_tag_name[tag],
+                        (run_tag_peak[tag] * PAGE_SIZE) / 1024);
+    }
 }
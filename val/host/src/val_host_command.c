@@ -27,16 +27,18 @@ uint64_t create_mapping(uint64_t ipa, bool ripas_init, uint64_t rd1)
     /* Fetch the rd of the Realm */
     uint64_t rd = rd1;
     val_host_rtt_entry_ts rtte;
-
-    /* Try a maximum walk and check where to create the next table entry */
-    if (val_host_rmi_rtt_read_entry(rd, ipa, MAP_LEVEL, &rtte)) {
-        LOG(ERROR, "ReadEntry query failed!\n");
-        return VAL_ERROR;
-    }
-
     uint64_t level, rtt_l1, rtt_l2, rtt_l3, out_top;
 
-    level = rtte.walk_level;
+    /* Check where to create the next table entry, from the RTT shadow or
+       else with a maximum walk */
+    if (val_host_rtt_shadow_level(rd, ipa, MAP_LEVEL, &level)) {
+        if (val_host_rmi_rtt_read_entry(rd, ipa, MAP_LEVEL, &rtte)) {
+            LOG(ERROR, "ReadEntry query failed!\n");
+            return VAL_ERROR;
+        }
+
+        level = rtte.walk_level;
+    }
 
     /* Delegate granules for RTTs */
     if (level < 1) {
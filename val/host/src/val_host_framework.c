@@ -12,6 +12,9 @@
 #include "pal_interfaces.h"
 #include "val.h"
 #include "val_host_memory.h"
+#ifdef VAL_SMC_TRACE
+#include "val_trace.h"
+#endif
 
 extern const uint32_t  total_tests;
 extern const test_db_t test_list[];
@@ -377,6 +380,11 @@ static void val_host_test_dispatch(bool primary_cpu_boot)
             }
 
             test_result = val_report_status();
+            val_host_mem_usage_report();
+#ifdef VAL_SMC_TRACE
+            val_trace_dump();
+            val_trace_reset();
+#endif
 
             if (val_nvm_read(VAL_NVM_OFFSET(NVM_TOTAL_PASS_INDEX),
                      &regre_report.total_pass, sizeof(uint32_t)) ||
@@ -408,9 +416,18 @@ static void val_host_test_dispatch(bool primary_cpu_boot)
             }
         }
 
+        /* Release the delegated granules kept across tests */
+        if (val_host_granule_pool_shrink(0))
+            LOG(WARN, "Granule pool drain failed\n");
+
         /* Print Regression report */
         val_print_regression_report(&regre_report);
+        val_host_mem_usage_summary();
     } else {
+        /* Secondary cpus woken up to share host work don't resume the test */
+        if (val_host_mp_worker_pending())
+            val_host_mp_worker();
+
         /* Resume the current test for secondary cpu */
         fn_ptr = (test_fptr_t)(test_list[val_get_curr_test_num()].host_fn);
         if (fn_ptr == NULL)
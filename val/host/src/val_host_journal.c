@@ -0,0 +1,526 @@
+/*
+ * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include "val_host_journal.h"
+#include "val_host_alloc.h"
+#include "val_host_rmi.h"
+#include "val_libc.h"
+#include "val_timer.h"
+
+/* Journal the RMI wrappers record into, NULL when not recording */
+static val_host_journal_ts *recording;
+/* Only the cpu which started the recording updates the journal */
+static uint64_t recording_mpidr;
+
+/**
+ *   @brief    Add the PA of a granule of the realm to the journal
+ *   @param    journal    - Journal being recorded
+ *   @param    pa         - PA of the granule
+ *   @return   void
+**/
+static void val_host_journal_granule_add(val_host_journal_ts *journal, uint64_t pa)
+{
+    if (journal->granule_count == journal->max_granules)
+    {
+        journal->overflow = true;
+        return;
+    }
+
+    journal->granules[journal->granule_count++] = pa;
+}
+
+/**
+ *   @brief    Add the granules a params copy refers to. The RTT roots and the
+ *             REC auxiliary granules are handed over to the RMM this way.
+ *   @param    journal    - Journal being recorded
+ *   @param    fid        - RMI command the params are for
+ *   @param    params     - Params copy
+ *   @return   void
+**/
+static void val_host_journal_params_add(val_host_journal_ts *journal, uint64_t fid,
+                                        void *params)
+{
+    val_host_realm_params_ts *realm_params = params;
+    val_host_rec_params_ts *rec_params = params;
+    uint64_t i, j;
+
+    if (fid == RMI_REC_CREATE)
+    {
+        for (i = 0; i < rec_params->num_aux && i < VAL_MAX_REC_AUX_GRANULES; i++)
+            val_host_journal_granule_add(journal, rec_params->aux[i]);
+        return;
+    }
+
+    for (j = 0; j < realm_params->rtt_num_start; j++)
+        val_host_journal_granule_add(journal, realm_params->rtt_base + j * PAGE_SIZE);
+
+    for (i = 0; i < realm_params->num_aux_planes && i < VAL_MAX_AUX_PLANES; i++)
+    {
+        if (realm_params->aux_rtt_base[i] == 0)
+            continue;
+
+        for (j = 0; j < realm_params->rtt_num_start; j++)
+            val_host_journal_granule_add(journal, realm_params->aux_rtt_base[i] + j * PAGE_SIZE);
+    }
+}
+
+/**
+ *   @brief    Start recording the RMI commands which set up a realm
+ *   @param    journal      - Journal to record into
+ *   @param    max_entries  - Maximum number of commands recorded
+ *   @return   SUCCESS/FAILURE
+**/
+uint32_t val_host_journal_start(val_host_journal_ts *journal, uint32_t max_entries)
+{
+    if (recording != NULL)
+    {
+        LOG(ERROR, "Journal already recording\n");
+        return VAL_ERROR;
+    }
+
+    /* Commands issued by several cpus at once can't be recorded in order */
+    if (val_host_populate_mode_get() == VAL_HOST_POPULATE_PARALLEL)
+    {
+        LOG(ERROR, "Journal can't record a parallel population\n");
+        return VAL_ERROR;
+    }
+
+    val_memset(journal, 0, sizeof(val_host_journal_ts));
+    journal->max_entries = max_entries;
+    journal->max_granules = 2 * max_entries;
+    journal->entries = val_host_mem_alloc(sizeof(uint64_t),
+                                          max_entries * sizeof(val_host_journal_entry_ts));
+    journal->granules = val_host_mem_alloc(sizeof(uint64_t),
+                                           journal->max_granules * sizeof(uint64_t));
+    journal->offsets = val_host_mem_alloc(sizeof(uint64_t),
+                                          journal->max_granules * sizeof(uint64_t));
+    if (!journal->entries || !journal->granules || !journal->offsets)
+    {
+        LOG(ERROR, "Failed to allocate journal, entries=%d\n", max_entries);
+        val_host_journal_release(journal);
+        return VAL_ERROR;
+    }
+
+    recording_mpidr = val_read_mpidr() & PAL_MPIDR_AFFINITY_MASK;
+    recording = journal;
+    return VAL_SUCCESS;
+}
+
+/**
+ *   @brief    Record an RMI command. Called by the RMI wrappers of the commands
+ *             that set up a realm, does nothing when not recording.
+ *   @param    fid        - RMI command
+ *   @param    x1 - x5    - Arguments of the command
+ *   @param    status     - Status returned by the command
+ *   @return   void
+**/
+void val_host_journal_record(uint64_t fid, uint64_t x1, uint64_t x2, uint64_t x3,
+                             uint64_t x4, uint64_t x5, uint64_t status)
+{
+    val_host_journal_ts *journal = recording;
+    val_host_journal_entry_ts *entry;
+    void *params;
+
+    if (journal == NULL)
+        return;
+
+    /* A command from another cpu can't be ordered with the recorded ones */
+    if ((val_read_mpidr() & PAL_MPIDR_AFFINITY_MASK) != recording_mpidr)
+    {
+        journal->unsupported = true;
+        return;
+    }
+
+    if (journal->count == journal->max_entries)
+    {
+        journal->overflow = true;
+        return;
+    }
+
+    entry = &journal->entries[journal->count];
+    entry->fid = (uint32_t)fid;
+    entry->granule_args = 0;
+    entry->params_arg = 0;
+    entry->reserved = 0;
+    entry->args[0] = x1;
+    entry->args[1] = x2;
+    entry->args[2] = x3;
+    entry->args[3] = x4;
+    entry->args[4] = x5;
+    entry->status = status;
+
+    /* The granule created by a command is added once, RD is then relocated
+       in the commands which follow */
+    switch (fid)
+    {
+        case RMI_GRANULE_DELEGATE:
+            break;
+        case RMI_REALM_CREATE:
+            entry->granule_args = 1 << 0;
+            entry->params_arg = 2;
+            if (!status)
+                val_host_journal_granule_add(journal, x1);
+            break;
+        case RMI_REC_CREATE:
+            entry->granule_args = (1 << 0) | (1 << 1);
+            entry->params_arg = 3;
+            if (!status)
+                val_host_journal_granule_add(journal, x2);
+            break;
+        case RMI_RTT_CREATE:
+        case RMI_RTT_AUX_CREATE:
+        case RMI_DATA_CREATE:
+        case RMI_DATA_CREATE_UNKNOWN:
+            entry->granule_args = (1 << 0) | (1 << 1);
+            if (!status)
+                val_host_journal_granule_add(journal, x2);
+            break;
+        case RMI_RTT_INIT_RIPAS:
+        case RMI_RTT_MAP_UNPROTECTED:
+        case RMI_RTT_AUX_MAP_PROTECTED:
+        case RMI_RTT_AUX_MAP_UNPROTECTED:
+        case RMI_REALM_ACTIVATE:
+            entry->granule_args = 1 << 0;
+            break;
+        default:
+            /* No inverse to tear down a replay with, e.g. RTT_FOLD */
+            journal->unsupported = true;
+            return;
+    }
+
+    /* Params are read by the RMM at replay, so keep a copy of them */
+    if (entry->params_arg)
+    {
+        params = val_host_mem_alloc_tag(PAGE_SIZE, PAGE_SIZE, VAL_HOST_MEM_TAG_PARAMS);
+        if (params == NULL)
+        {
+            journal->overflow = true;
+            return;
+        }
+
+        val_memcpy(params, (void *)entry->args[entry->params_arg - 1], PAGE_SIZE);
+        entry->args[entry->params_arg - 1] = (uint64_t)params;
+        if (!status)
+            val_host_journal_params_add(journal, fid, params);
+    }
+
+    journal->count++;
+}
+
+/**
+ *   @brief    Stop recording. The granules of the realm are laid out for the
+ *             replay region, keeping the physically contiguous ones together.
+ *   @param    void
+ *   @return   SUCCESS/FAILURE
+**/
+uint32_t val_host_journal_stop(void)
+{
+    val_host_journal_ts *journal = recording;
+    uint64_t pa, align, cursor = 0;
+    uint32_t i, j, count = 0;
+
+    if (journal == NULL)
+        return VAL_ERROR;
+
+    recording = NULL;
+
+    if (journal->overflow || journal->unsupported)
+    {
+        LOG(ERROR, "Journal can't be replayed, entries=%d\n", journal->count);
+        return VAL_ERROR;
+    }
+
+    /* Sort the granules and drop the ones recorded twice */
+    for (i = 1; i < journal->granule_count; i++)
+    {
+        pa = journal->granules[i];
+        for (j = i; j > 0 && journal->granules[j - 1] > pa; j--)
+            journal->granules[j] = journal->granules[j - 1];
+        journal->granules[j] = pa;
+    }
+
+    for (i = 0; i < journal->granule_count; i++)
+    {
+        if (count && journal->granules[count - 1] == journal->granules[i])
+            continue;
+        journal->granules[count++] = journal->granules[i];
+    }
+    journal->granule_count = count;
+
+    for (i = 0; i < count; i++)
+    {
+        pa = journal->granules[i];
+        if (i && (pa == journal->granules[i - 1] + PAGE_SIZE))
+        {
+            journal->offsets[i] = journal->offsets[i - 1] + PAGE_SIZE;
+        } else {
+            align = pa & (~pa + 1);
+            if (align > VAL_HOST_JOURNAL_ALIGN_MAX)
+                align = VAL_HOST_JOURNAL_ALIGN_MAX;
+            cursor = ADDR_ALIGN(cursor, align);
+            journal->offsets[i] = cursor;
+        }
+        cursor = journal->offsets[i] + PAGE_SIZE;
+    }
+    journal->region_size = cursor;
+
+    return VAL_SUCCESS;
+}
+
+/**
+ *   @brief    Get the replay PA of a recorded granule
+ *   @param    journal    - Journal
+ *   @param    pa         - Recorded PA of the granule
+ *   @return   Returns the PA in the replay region, 0 if not recorded
+**/
+static uint64_t val_host_journal_reloc(val_host_journal_ts *journal, uint64_t pa)
+{
+    uint32_t low = 0, high = journal->granule_count, mid;
+
+    while (low < high)
+    {
+        mid = (low + high) / 2;
+        if (journal->granules[mid] == pa)
+            return journal->region + journal->offsets[mid];
+
+        if (journal->granules[mid] < pa)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return 0;
+}
+
+/**
+ *   @brief    Delegate the replay region and point the journal at it
+ *   @param    journal    - Journal
+ *   @return   SUCCESS/FAILURE
+**/
+static uint32_t val_host_journal_prepare(val_host_journal_ts *journal)
+{
+    val_host_realm_params_ts *realm_params;
+    val_host_rec_params_ts *rec_params;
+    val_host_journal_entry_ts *entry;
+    uint64_t *arg;
+    uint32_t i, j;
+
+    journal->region = (uint64_t)val_host_mem_alloc(VAL_HOST_JOURNAL_ALIGN_MAX,
+                                                   journal->region_size);
+    if (!journal->region)
+    {
+        LOG(ERROR, "Failed to allocate replay region, size=0x%x\n", journal->region_size);
+        return VAL_ERROR;
+    }
+
+    for (; journal->delegated < journal->granule_count; journal->delegated++)
+    {
+        if (val_host_rmi_granule_delegate(journal->region +
+                                          journal->offsets[journal->delegated]))
+        {
+            LOG(ERROR, "Granule delegation failed, PA=0x%x\n",
+                        journal->region + journal->offsets[journal->delegated]);
+            return VAL_ERROR;
+        }
+    }
+
+    for (i = 0; i < journal->count; i++)
+    {
+        entry = &journal->entries[i];
+        for (j = 0; j < VAL_HOST_JOURNAL_ARGS; j++)
+        {
+            arg = &entry->args[j];
+            if ((entry->granule_args & (1 << j)) && val_host_journal_reloc(journal, *arg))
+                *arg = val_host_journal_reloc(journal, *arg);
+        }
+
+        if (!entry->params_arg)
+            continue;
+
+        if (entry->fid == RMI_REC_CREATE)
+        {
+            rec_params = (val_host_rec_params_ts *)entry->args[entry->params_arg - 1];
+            for (j = 0; j < rec_params->num_aux && j < VAL_MAX_REC_AUX_GRANULES; j++)
+                rec_params->aux[j] = val_host_journal_reloc(journal, rec_params->aux[j]);
+            continue;
+        }
+
+        realm_params = (val_host_realm_params_ts *)entry->args[entry->params_arg - 1];
+        realm_params->rtt_base = val_host_journal_reloc(journal, realm_params->rtt_base);
+        for (j = 0; j < realm_params->num_aux_planes && j < VAL_MAX_AUX_PLANES; j++)
+        {
+            if (realm_params->aux_rtt_base[j])
+                realm_params->aux_rtt_base[j] =
+                                val_host_journal_reloc(journal, realm_params->aux_rtt_base[j]);
+        }
+    }
+
+    journal->prepared = true;
+    return VAL_SUCCESS;
+}
+
+/**
+ *   @brief    Destroy what the replay of the first entries of a journal created,
+ *             in reverse order
+ *   @param    journal    - Journal
+ *   @param    end        - Number of entries replayed
+ *   @return   SUCCESS/FAILURE
+**/
+static uint32_t val_host_journal_undo(val_host_journal_ts *journal, uint32_t end)
+{
+    val_host_journal_entry_ts *entry;
+    uint64_t *args, ret;
+    uint32_t status = VAL_SUCCESS;
+
+    while (end-- > 0)
+    {
+        entry = &journal->entries[end];
+        args = entry->args;
+        if (entry->status)
+            continue;
+
+        switch (entry->fid)
+        {
+            case RMI_DATA_CREATE:
+            case RMI_DATA_CREATE_UNKNOWN:
+                ret = val_smc_call(RMI_DATA_DESTROY, args[0], args[2],
+                                   0, 0, 0, 0, 0, 0, 0, 0).x0;
+                break;
+            case RMI_RTT_CREATE:
+                ret = val_smc_call(RMI_RTT_DESTROY, args[0], args[2], args[3],
+                                   0, 0, 0, 0, 0, 0, 0).x0;
+                break;
+            case RMI_RTT_AUX_CREATE:
+                ret = val_smc_call(RMI_RTT_AUX_DESTROY, args[0], args[2], args[3], args[4],
+                                   0, 0, 0, 0, 0, 0).x0;
+                break;
+            case RMI_RTT_MAP_UNPROTECTED:
+                ret = val_smc_call(RMI_RTT_UNMAP_UNPROTECTED, args[0], args[1], args[2],
+                                   0, 0, 0, 0, 0, 0, 0).x0;
+                break;
+            case RMI_RTT_AUX_MAP_PROTECTED:
+                ret = val_smc_call(RMI_RTT_AUX_UNMAP_PROTECTED, args[0], args[1], args[2],
+                                   0, 0, 0, 0, 0, 0, 0).x0;
+                break;
+            case RMI_RTT_AUX_MAP_UNPROTECTED:
+                ret = val_smc_call(RMI_RTT_AUX_UNMAP_UNPROTECTED, args[0], args[1], args[2],
+                                   0, 0, 0, 0, 0, 0, 0).x0;
+                break;
+            case RMI_REC_CREATE:
+                ret = val_smc_call(RMI_REC_DESTROY, args[1], 0, 0, 0, 0, 0, 0, 0, 0, 0).x0;
+                break;
+            case RMI_REALM_CREATE:
+                ret = val_smc_call(RMI_REALM_DESTROY, args[0], 0, 0, 0, 0, 0, 0, 0, 0, 0).x0;
+                break;
+            default:
+                ret = 0;
+                break;
+        }
+
+        if (ret)
+        {
+            LOG(ERROR, "Journal undo failed, entry=%d, ret=0x%x\n", end, ret);
+            status = VAL_ERROR;
+        }
+    }
+
+    return status;
+}
+
+/**
+ *   @brief    Replay a journal a number of times. Each replay issues the
+ *             recorded commands straight to the RMM on delegated granules of
+ *             the replay region, checks they return the recorded status and
+ *             then destroys the realm. Host tracking isn't updated.
+ *   @param    journal    - Journal recorded with val_host_journal_start/stop
+ *   @param    count      - Number of replays
+ *   @param    ticks      - Counter ticks spent in the replays, without the
+ *                          teardown, added to if not NULL
+ *   @return   SUCCESS/FAILURE
+**/
+uint32_t val_host_journal_replay(val_host_journal_ts *journal, uint32_t count, uint64_t *ticks)
+{
+    val_host_journal_entry_ts *entry;
+    uint64_t start, *args;
+    uint32_t i, n;
+
+    if (!journal->prepared && val_host_journal_prepare(journal))
+        return VAL_ERROR;
+
+    for (n = 0; n < count; n++)
+    {
+        start = val_read_cntpct_el0();
+        for (i = 0; i < journal->count; i++)
+        {
+            entry = &journal->entries[i];
+            args = entry->args;
+
+            /* The replay region is delegated up front */
+            if (entry->fid == RMI_GRANULE_DELEGATE)
+                continue;
+
+            if (val_smc_call(entry->fid, args[0], args[1], args[2], args[3], args[4],
+                             0, 0, 0, 0, 0).x0 != entry->status)
+                break;
+        }
+
+        if (ticks != NULL)
+            *ticks += val_read_cntpct_el0() - start;
+
+        if (i < journal->count)
+        {
+            LOG(ERROR, "Journal replay diverged, entry=%d, fid=0x%x\n", i, entry->fid);
+            (void)val_host_journal_undo(journal, i);
+            return VAL_ERROR;
+        }
+
+        if (val_host_journal_undo(journal, journal->count))
+            return VAL_ERROR;
+    }
+
+    return VAL_SUCCESS;
+}
+
+/**
+ *   @brief    Free a journal and undelegate its replay region
+ *   @param    journal    - Journal
+ *   @return   void
+**/
+void val_host_journal_release(val_host_journal_ts *journal)
+{
+    val_host_journal_entry_ts *entry;
+    uint32_t i;
+
+    if (recording == journal)
+        recording = NULL;
+
+    for (i = 0; i < journal->delegated; i++)
+    {
+        if (val_host_rmi_granule_undelegate(journal->region + journal->offsets[i]))
+            LOG(ERROR, "Granule undelegation failed, PA=0x%x\n",
+                        journal->region + journal->offsets[i]);
+    }
+
+    if (journal->region)
+        val_host_mem_free((void *)journal->region);
+
+    for (i = 0; journal->entries != NULL && i < journal->count; i++)
+    {
+        entry = &journal->entries[i];
+        if (entry->params_arg)
+            val_host_mem_free((void *)entry->args[entry->params_arg - 1]);
+    }
+
+    if (journal->entries)
+        val_host_mem_free(journal->entries);
+    if (journal->granules)
+        val_host_mem_free(journal->granules);
+    if (journal->offsets)
+        val_host_mem_free(journal->offsets);
+
+    val_memset(journal, 0, sizeof(val_host_journal_ts));
+}
@@ -52,6 +52,10 @@ extern uintptr_t __BSS_START__, __BSS_END__;
                                 PLATFORM_MEMORY_POOL_SIZE,      \
                                 MT_RW_DATA | MT_NS,              \
                                 0x1000)
+#define REALM_IMAGE_HEADER MAP_REGION_FLAT(                      \
+                                PLATFORM_REALM_IMAGE_BASE,      \
+                                PAGE_SIZE,                      \
+                                MT_RO_DATA | MT_NS)
 #define NS_UART MAP_REGION_FLAT(                                \
                                 PLATFORM_NS_UART_BASE,          \
                                 PLATFORM_NS_UART_SIZE,          \
@@ -101,7 +105,8 @@ void val_host_add_mmap(void)
             HOST_RO,
             HOST_RW,
             HOST_BSS,
-            MEMORY_POOL
+            MEMORY_POOL,
+            REALM_IMAGE_HEADER
     };
 
     mmap_add_ctx(&acs_host_xlat_ctx, host_regions);
@@ -8,24 +8,129 @@
 #include "val_host_realm.h"
 #include "val_host_alloc.h"
 #include "val_host_helpers.h"
+#include "val_host_mp.h"
+#include "val_timer.h"
 
 int current_realm = 1;
-val_host_granule_ts *head = NULL;
 val_host_granule_ts *current = NULL;
-val_host_granule_ts *tail = NULL;
-
-val_host_memory_track_ts mem_track[VAL_HOST_MAX_REALMS] = {
-    {.rd = 0x00000000FFFFFFFF},
-    {.rd = 0x00000000FFFFFFFF},
-    {.rd = 0x00000000FFFFFFFF},
-    {.rd = 0x00000000FFFFFFFF},
-    {.rd = 0x00000000FFFFFFFF},
-    {.rd = 0x00000000FFFFFFFF},
-    {.rd = 0x00000000FFFFFFFF},
-    {.rd = 0x00000000FFFFFFFF},
-    {.rd = 0x00000000FFFFFFFF},
-    {.rd = 0x00000000FFFFFFFF}
-};
+
+#define VAL_HOST_TRACK_NODES_PER_PAGE (PAGE_SIZE / sizeof(val_host_granule_ts))
+static val_host_granule_ts *track_free_list;
+
+/* Open addressing index of the NS mem_track list by PA. The number of slots is
+ * a power of 2 and at most half of them are used. */
+#define VAL_HOST_GRANULE_INDEX_MIN_SLOTS 1024
+static val_host_granule_ts **granule_index;
+static uint64_t granule_index_slots;
+static uint64_t granule_index_count;
+
+/* Radix tree over the granule number of IPAs, with page sized tables of
+ * 512 entries like stage 2 tables. Tables are released with the heap. */
+#define VAL_HOST_IPA_INDEX_BITS     9
+#define VAL_HOST_IPA_INDEX_ENTRIES  (1UL << VAL_HOST_IPA_INDEX_BITS)
+#define VAL_HOST_IPA_INDEX_LEVELS   5
+
+typedef struct {
+    void *entry[VAL_HOST_IPA_INDEX_ENTRIES];
+} val_host_ipa_table_ts;
+
+/* Packed state of each 4KB granule of the memory pool. Granules without realm
+ * metadata are only recorded here, the others point to a mem_track node. */
+#define VAL_HOST_GRANULE_MAP_SHIFT        12
+#define VAL_HOST_GRANULE_MAP_BITS         2
+#define VAL_HOST_GRANULE_MAP_PER_WORD     (64 / VAL_HOST_GRANULE_MAP_BITS)
+#define VAL_HOST_GRANULE_MAP_GRANULES     (PLATFORM_MEMORY_POOL_SIZE >> VAL_HOST_GRANULE_MAP_SHIFT)
+#define VAL_HOST_GRANULE_MAP_WORDS        ((VAL_HOST_GRANULE_MAP_GRANULES + \
+                                            VAL_HOST_GRANULE_MAP_PER_WORD - 1) / \
+                                            VAL_HOST_GRANULE_MAP_PER_WORD)
+#define VAL_HOST_GRANULE_MAP_LOW_BITS     0x5555555555555555ULL
+
+#define VAL_HOST_GRANULE_MAP_NONE         0
+#define VAL_HOST_GRANULE_MAP_DELEGATED    1
+#define VAL_HOST_GRANULE_MAP_UNDELEGATED  2
+#define VAL_HOST_GRANULE_MAP_NODE         3
+
+static uint64_t granule_map[VAL_HOST_GRANULE_MAP_WORDS];
+
+/* Realm registry. The slots start in a static array and move to the heap,
+ * doubling, when more realms are live. Slots below mem_track_top that are not
+ * in use are chained from mem_track_free. */
+static val_host_memory_track_ts mem_track_static[VAL_HOST_REALM_SLOTS_MIN];
+val_host_memory_track_ts *mem_track = mem_track_static;
+static uint32_t mem_track_slots = VAL_HOST_REALM_SLOTS_MIN;
+static uint32_t mem_track_top = 1;
+static uint32_t mem_track_free;
+
+/* Open addressing index of the registry by RD, with twice as many entries as
+ * slots. An entry holds a slot number, 0 marks an empty entry. */
+static uint32_t realm_index_static[2 * VAL_HOST_REALM_SLOTS_MIN];
+static uint32_t *realm_index = realm_index_static;
+
+static val_host_teardown_mode_te teardown_mode;
+static val_host_map_mode_te map_mode;
+static bool rtt_shadow_check;
+
+/* Serialises mem_track updates, which come from several CPUs during a parallel
+ * postamble. It is taken before heap_lock, never while holding it. */
+static s_lock_t track_lock;
+
+/* DATA of realms with at least this many granules is split in IPA ranges
+ * between the CPUs of a parallel postamble */
+#define VAL_HOST_POSTAMBLE_SPLIT_MIN 64
+
+/* Protected ranges spanning at least this many L2 regions are populated by
+ * all the CPUs in the parallel population mode */
+#define VAL_HOST_POPULATE_SPLIT_MIN 4
+
+/* Work shared with the secondary CPUs by a parallel postamble or population */
+typedef enum {
+    /* Destroy the DATA in an IPA range of a realm */
+    VAL_HOST_MP_WORK_UNMAP_RANGE = 0,
+    /* Destroy a whole realm */
+    VAL_HOST_MP_WORK_DESTROY_REALM,
+    /* Map an IPA range of protected memory into a realm */
+    VAL_HOST_MP_WORK_MAP_RANGE
+} val_host_mp_work_op_te;
+
+typedef struct {
+    val_host_mp_work_op_te op;
+    uint64_t rd;
+    uint64_t base;
+    uint64_t top;
+    /* Used by VAL_HOST_MP_WORK_MAP_RANGE only */
+    val_host_realm_ts *realm;
+    uint64_t target_pa;
+    uint64_t src_pa;
+    uint64_t rtt_alignment;
+} val_host_mp_work_ts;
+
+static val_host_postamble_mode_te postamble_mode;
+static val_host_populate_mode_te populate_mode;
+static val_host_mp_work_ts *mp_work;
+static uint32_t mp_work_next;
+static uint32_t mp_work_end;
+static uint32_t mp_status;
+static volatile bool mp_active;
+static s_lock_t mp_lock;
+static event_t mp_go[PLATFORM_CPU_COUNT];
+static event_t mp_done;
+
+/* Tracked RTT of a realm, as needed to destroy it */
+typedef struct {
+    uint64_t ipa;
+    uint64_t level;
+    uint64_t PA;
+} val_host_rtt_ref_ts;
+
+/* State of a depth first teardown of the primary RTT tree of a realm */
+typedef struct {
+    uint64_t rd;
+    int realm;
+    uint64_t unprotected_base;
+    val_host_rtt_ref_ts *rtts;
+    uint64_t rtt_count;
+    bool exhaustive;
+} val_host_rtt_walk_ts;
 
 uint64_t aux_ipa_base[VAL_MAX_AUX_PLANES] = {
     VAL_PLANE1_IMAGE_BASE_IPA,
@@ -63,14 +168,10 @@ uint32_t val_host_create_rtt_levels(val_host_realm_ts *realm,
 
     for (; rtt_level++ < rtt_max_level;)
     {
-        rtt = (uint64_t)val_host_mem_alloc(rtt_alignment, PAGE_SIZE);
+        rtt = val_host_granule_pool_get(rtt_alignment);
         if (!rtt)
         {
-            LOG(ERROR, "Failed to allocate memory for rtt\n");
-            return VAL_ERROR;
-        } else if (val_host_rmi_granule_delegate(rtt))
-        {
-            LOG(ERROR, "Rtt delegation failed, rtt=0x%x\n", rtt);
+            LOG(ERROR, "Failed to get delegated granule for rtt\n");
             return VAL_ERROR;
         }
 
@@ -78,8 +179,7 @@ uint32_t val_host_create_rtt_levels(val_host_realm_ts *realm,
         if (val_host_rmi_rtt_create(realm->rd, rtt, rtt_ipa, rtt_level))
         {
             LOG(ERROR, "Rtt create failed, rtt=0x%x\n", rtt);
-            val_host_rmi_granule_undelegate(rtt);
-            val_host_mem_free((void *)rtt);
+            val_host_granule_pool_put(rtt);
             return VAL_ERROR;
         }
     }
@@ -111,14 +211,10 @@ uint32_t val_host_create_aux_rtt_levels(val_host_realm_ts *realm,
 
     for (; rtt_level++ < rtt_max_level;)
     {
-        rtt = (uint64_t)val_host_mem_alloc(rtt_alignment, PAGE_SIZE);
+        rtt = val_host_granule_pool_get(rtt_alignment);
         if (!rtt)
         {
-            LOG(ERROR, "Failed to allocate memory for aux rtt\n");
-            return VAL_ERROR;
-        } else if (val_host_rmi_granule_delegate(rtt))
-        {
-            LOG(ERROR, "AUX RTT delegation failed, rtt=0x%x\n", rtt);
+            LOG(ERROR, "Failed to get delegated granule for aux rtt\n");
             return VAL_ERROR;
         }
 
@@ -127,10 +223,72 @@ uint32_t val_host_create_aux_rtt_levels(val_host_realm_ts *realm,
         if (cmd_ret.x0)
         {
             LOG(ERROR, "Rtt create failed, rtt=0x%x\n", rtt);
-            val_host_rmi_granule_undelegate(rtt);
-            val_host_mem_free((void *)rtt);
+            val_host_granule_pool_put(rtt);
+            return VAL_ERROR;
+        }
+    }
+
+    return VAL_SUCCESS;
+}
+
+/**
+ *   @brief    Set how protected memory is mapped into realms. The mode is reset
+ *             to VAL_HOST_MAP_PAGES for every test.
+ *   @param    mode    -  Mapping mode
+ *   @return   void
+**/
+void val_host_map_mode_set(val_host_map_mode_te mode)
+{
+    map_mode = mode;
+}
+
+/**
+ *   @brief    Check whether protected memory of a realm is folded into blocks.
+ *             Realms with an RTT tree per plane keep page entries, as their
+ *             auxiliary trees map the same pages.
+ *   @param    realm        - Realm strucrure
+ *   @return   Returns true if 2MB aligned regions are folded
+**/
+static bool val_host_map_blocks(val_host_realm_ts *realm)
+{
+    if (map_mode != VAL_HOST_MAP_L2_BLOCKS)
+        return false;
+
+    return !(VAL_EXTRACT_BITS(realm->flags1, 0, 0) && realm->num_aux_planes > 0);
+}
+
+/**
+ *   @brief    Fold the L3 RTTs of the 2MB aligned regions of a mapped
+ *             protected range into L2 block entries. The RTTs are returned to
+ *             the granule pool.
+ *   @param    realm        - Realm strucrure
+ *   @param    target_pa    - PA of target data for the base of the range
+ *   @param    base         - Base of the IPA range
+ *   @param    top          - Top of the IPA range, exclusive
+ *   @return   SUCCESS/FAILURE
+**/
+static uint32_t val_host_fold_data_range(val_host_realm_ts *realm, uint64_t target_pa,
+                                         uint64_t base, uint64_t top)
+{
+    uint64_t ipa, rtt, ret;
+
+    ipa = ADDR_ALIGN_DOWN(base + VAL_RTT_L2_BLOCK_SIZE - 1, VAL_RTT_L2_BLOCK_SIZE);
+
+    /* Blocks need the PA to be aligned like the IPA */
+    if (!ADDR_IS_ALIGNED(target_pa + (ipa - base), VAL_RTT_L2_BLOCK_SIZE))
+        return VAL_SUCCESS;
+
+    for (; ipa + VAL_RTT_L2_BLOCK_SIZE <= top; ipa += VAL_RTT_L2_BLOCK_SIZE)
+    {
+        ret = val_host_rmi_rtt_fold(realm->rd, ipa, VAL_RTT_MAX_LEVEL, &rtt);
+        if (ret)
+        {
+            LOG(ERROR, "val_host_rmi_rtt_fold failed, ipa=0x%x, ret=0x%x\n", ipa, ret);
             return VAL_ERROR;
         }
+
+        if (val_host_granule_pool_put(rtt))
+            return VAL_ERROR;
     }
 
     return VAL_SUCCESS;
@@ -156,6 +314,7 @@ uint32_t val_host_map_protected_data(val_host_realm_ts *realm,
     uint64_t ret = 0;
     uint64_t size = 0;
     uint64_t phys = target_pa;
+    uint64_t ipa_base = ipa;
     uint64_t flags = RMI_NO_MEASURE_CONTENT;
     val_host_rtt_entry_ts  rtte;
     val_host_data_destroy_ts data_destroy;
@@ -175,10 +334,19 @@ uint32_t val_host_map_protected_data(val_host_realm_ts *realm,
 
     while (size < rtt_map_size)
     {
+        /* Create the RTTs missing from the shadow before DATA_CREATE */
+        if (!val_host_rtt_shadow_level(rd, ipa, VAL_RTT_MAX_LEVEL, &rtt_level) &&
+            (rtt_level < VAL_RTT_MAX_LEVEL) &&
+            val_host_create_rtt_levels(realm, ipa, rtt_level, VAL_RTT_MAX_LEVEL, PAGE_SIZE))
+        {
+            LOG(ERROR, "val_realm_create_rtt_levels failed, ipa=0x%x\n", ipa);
+            goto error;
+        }
+
         if (val_host_rmi_granule_delegate(phys))
         {
             LOG(ERROR, "Granule delegation failed, PA=0x%x\n", phys);
-            return VAL_ERROR;
+            goto error;
         }
 
         ret = val_host_rmi_data_create(rd, phys, ipa, src_pa, flags);
@@ -191,18 +359,19 @@ uint32_t val_host_map_protected_data(val_host_realm_ts *realm,
             if (ret)
             {
                 LOG(ERROR, "val_host_rmi_rtt_read_entry, ret=0x%x\n", ret);
-                return VAL_ERROR;
+                goto undelegate;
             }
 
             if (rtte.state == RMI_UNASSIGNED)
             {
-                /* Create missing RTT levels and retry data create again */
+                /* Create missing RTT levels and retry data create again. DATA
+                   is always created with page entries. */
                 ret = val_host_create_rtt_levels(realm, ipa, (uint32_t)rtte.walk_level,
-                                map_level, PAGE_SIZE);
+                                VAL_RTT_MAX_LEVEL, PAGE_SIZE);
                 if (ret)
                 {
                     LOG(ERROR, "val_realm_create_rtt_levels failed, ret=0x%x\n", ret);
-                    goto error;
+                    goto undelegate;
                 }
 
                 ret = val_host_rmi_data_create(rd, phys, ipa, src_pa, flags);
@@ -212,7 +381,7 @@ uint32_t val_host_map_protected_data(val_host_realm_ts *realm,
         if (ret)
         {
             LOG(ERROR, "val_rmi_data_create failed, ret=0x%x\n", ret);
-            goto error;
+            goto undelegate;
         }
 
         phys += PAGE_SIZE;
@@ -221,28 +390,200 @@ uint32_t val_host_map_protected_data(val_host_realm_ts *realm,
         size += PAGE_SIZE;
     }
 
+    if (map_level == VAL_RTT_BLOCK_LEVEL && val_host_map_blocks(realm))
+        return val_host_fold_data_range(realm, target_pa, ipa_base, ipa_base + rtt_map_size);
+
     return VAL_SUCCESS;
 
+    /* The failing granule is delegated but has no DATA */
+undelegate:
+    if (val_host_rmi_granule_undelegate(phys))
+    {
+        LOG(ERROR, "val_rmi_granule_undelegate failed\n");
+    }
+
+    /* Destroy the DATA created before the failing granule, last one first */
 error:
-    for (; size > 0;)
+    while (size > 0)
     {
+        phys -= PAGE_SIZE;
+        size -= PAGE_SIZE;
+        ipa -= PAGE_SIZE;
+
         ret = val_host_rmi_data_destroy(rd, ipa, &data_destroy);
         if (ret)
-            LOG(ERROR, "val_rmi_rtt_mapprotected failed, ret=0x%x\n", ret);
+            LOG(ERROR, "val_rmi_data_destroy failed, ret=0x%x\n", ret);
 
         ret = val_host_rmi_granule_undelegate(phys);
         if (ret)
         {
             LOG(ERROR, "val_rmi_granule_undelegate failed\n");
         }
-        phys -= PAGE_SIZE;
-        size -= PAGE_SIZE;
+    }
+
+    return VAL_ERROR;
+}
+
+/**
+ *   @brief    Create the RTTs missing to map an IPA range at a given level.
+ *             Each region covered by one RTT of that level is checked once.
+ *   @param    realm         - Realm strucrure
+ *   @param    base          - Base of the IPA range
+ *   @param    top           - Top of the IPA range, exclusive
+ *   @param    rtt_max_level - Level of the mappings
+ *   @param    rtt_alignment - RTT Address Alignment
+ *   @return   SUCCESS/FAILURE
+**/
+uint32_t val_host_create_rtt_range(val_host_realm_ts *realm,
+                   uint64_t base,
+                   uint64_t top,
+                   uint64_t rtt_max_level,
+                   uint64_t rtt_alignment)
+{
+    uint64_t ipa, region_size, walk_level;
+    val_host_rtt_entry_ts rtte;
+
+    if (rtt_max_level == 0 || rtt_max_level > VAL_RTT_MAX_LEVEL)
+        return VAL_ERROR;
+
+    region_size = val_host_rtt_level_mapsize(rtt_max_level - 1);
+
+    for (ipa = ADDR_ALIGN_DOWN(base, region_size); ipa < top; ipa += region_size)
+    {
+        /* Without a shadow, read the RTT entry back */
+        if (val_host_rtt_shadow_level(realm->rd, ipa, rtt_max_level, &walk_level))
+        {
+            if (val_host_rmi_rtt_read_entry(realm->rd, ipa, rtt_max_level, &rtte))
+            {
+                LOG(ERROR, "val_host_rmi_rtt_read_entry failed, ipa=0x%x\n", ipa);
+                return VAL_ERROR;
+            }
+
+            if ((rtte.walk_level != rtt_max_level) && (rtte.state != RMI_UNASSIGNED))
+            {
+                LOG(ERROR, "Range already mapped by a block, ipa=0x%x\n", ipa);
+                return VAL_ERROR;
+            }
+            walk_level = rtte.walk_level;
+        }
+
+        if (walk_level == rtt_max_level)
+            continue;
+
+        if (val_host_create_rtt_levels(realm, ipa, walk_level, rtt_max_level, rtt_alignment))
+        {
+            LOG(ERROR, "val_host_create_rtt_levels failed, ipa=0x%x\n", ipa);
+            return VAL_ERROR;
+        }
+    }
+
+    return VAL_SUCCESS;
+}
+
+/**
+ *   @brief    Maps a range of protected memory into the realm. The RTTs of the
+ *             range are created and its RIPAS is initialised first, so every
+ *             DATA_CREATE succeeds on the first try. Pages from load_top on
+ *             are created with unknown contents.
+ *   @param    realm         - Realm strucrure
+ *   @param    target_pa     - PA of target data for the base of the range
+ *   @param    base          - Base of the IPA range
+ *   @param    load_top      - Top of the IPA range loaded from src_pa
+ *   @param    top           - Top of the IPA range, exclusive
+ *   @param    src_pa        - PA of source granule for the base of the range
+ *   @param    rtt_alignment - RTT Address Alignment
+ *   @return   SUCCESS/FAILURE
+**/
+static uint32_t val_host_map_protected_range(val_host_realm_ts *realm,
+                uint64_t target_pa,
+                uint64_t base,
+                uint64_t load_top,
+                uint64_t top,
+                uint64_t src_pa,
+                uint64_t rtt_alignment)
+{
+    uint64_t ipa, offset;
+    uint64_t ret = 0;
+    uint64_t flags = RMI_NO_MEASURE_CONTENT;
+    val_host_data_destroy_ts data_destroy;
+
+    if (!ADDR_IS_ALIGNED(base, PAGE_SIZE) || !ADDR_IS_ALIGNED(top, PAGE_SIZE) || top < base ||
+        !ADDR_IS_ALIGNED(load_top, PAGE_SIZE) || load_top < base || load_top > top)
+        return VAL_ERROR;
+
+    if (val_host_create_rtt_range(realm, base, top, VAL_RTT_MAX_LEVEL, rtt_alignment))
+        return VAL_ERROR;
+
+    if (val_host_ripas_init(realm, base, top, VAL_RTT_MAX_LEVEL, rtt_alignment))
+    {
+        LOG(ERROR, "val_host_ripas_init failed, ipa=0x%x\n", base);
+        return VAL_ERROR;
+    }
+
+    for (ipa = base; ipa < top; ipa += PAGE_SIZE)
+    {
+        offset = ipa - base;
+        if (val_host_rmi_granule_delegate(target_pa + offset))
+        {
+            LOG(ERROR, "Granule delegation failed, PA=0x%x\n", target_pa + offset);
+            goto error;
+        }
+
+        if (ipa < load_top)
+            ret = val_host_rmi_data_create(realm->rd, target_pa + offset, ipa,
+                                           src_pa + offset, flags);
+        else
+            ret = val_host_rmi_data_create_unknown(realm->rd, target_pa + offset, ipa);
+        if (ret)
+        {
+            LOG(ERROR, "val_rmi_data_create failed, ipa=0x%x, ret=0x%x\n", ipa, ret);
+            if (val_host_rmi_granule_undelegate(target_pa + offset))
+                LOG(ERROR, "val_rmi_granule_undelegate failed\n");
+            goto error;
+        }
+    }
+
+    if (val_host_map_blocks(realm))
+        return val_host_fold_data_range(realm, target_pa, base, top);
+
+    return VAL_SUCCESS;
+
+error:
+    while (ipa > base)
+    {
         ipa -= PAGE_SIZE;
+        if (val_host_rmi_data_destroy(realm->rd, ipa, &data_destroy) ||
+            val_host_rmi_granule_undelegate(target_pa + (ipa - base)))
+        {
+            LOG(ERROR, "Failed to unmap protected data, ipa=0x%x\n", ipa);
+        }
     }
 
     return VAL_ERROR;
 }
 
+/**
+ *   @brief    Maps a range of protected memory into the realm. The RTTs of the
+ *             range are created and its RIPAS is initialised first, so every
+ *             DATA_CREATE succeeds on the first try.
+ *   @param    realm         - Realm strucrure
+ *   @param    target_pa     - PA of target data for the base of the range
+ *   @param    base          - Base of the IPA range
+ *   @param    top           - Top of the IPA range, exclusive
+ *   @param    src_pa        - PA of source granule for the base of the range
+ *   @param    rtt_alignment - RTT Address Alignment
+ *   @return   SUCCESS/FAILURE
+**/
+uint32_t val_host_map_protected_data_range(val_host_realm_ts *realm,
+                uint64_t target_pa,
+                uint64_t base,
+                uint64_t top,
+                uint64_t src_pa,
+                uint64_t rtt_alignment)
+{
+    return val_host_map_protected_range(realm, target_pa, base, top, top, src_pa, rtt_alignment);
+}
+
 /**
  *   @brief    Maps protected memory into the realm with unknown contents
  *   @param    realm        - Realm strucrure
@@ -408,6 +749,94 @@ error:
     return VAL_ERROR;
 }
 
+/**
+ *   @brief    Maps a range of protected memory of the realm in an auxiliary
+ *             RTT. The aux RTTs missing for the range are created once per
+ *             last level table, from the level RTT_AUX_MAP_PROTECTED fails at
+ *             for the first page it covers, then the range is mapped in order.
+ *   @param    realm        - Realm strucrure
+ *   @param    base         - Base of the IPA range
+ *   @param    top          - Top of the IPA range, exclusive
+ *   @param    index        - Aux RTT index
+ *   @return   SUCCESS/FAILURE
+**/
+static uint32_t val_host_aux_map_protected_range(val_host_realm_ts *realm, uint64_t base,
+                                                 uint64_t top, uint64_t index)
+{
+    uint64_t ipa;
+    val_smc_param_ts cmd_ret;
+
+    if (!ADDR_IS_ALIGNED(base, PAGE_SIZE) || !ADDR_IS_ALIGNED(top, PAGE_SIZE))
+        return VAL_ERROR;
+
+    for (ipa = base; ipa < top; ipa += PAGE_SIZE)
+    {
+        cmd_ret = val_host_rmi_rtt_aux_map_protected(realm->rd, ipa, index);
+
+        /* Only the first page of a last level table can miss its RTTs */
+        if ((RMI_STATUS(cmd_ret.x0) == RMI_ERROR_RTT_AUX) &&
+            ((ipa == base) || ADDR_IS_ALIGNED(ipa, VAL_RTT_L2_BLOCK_SIZE)))
+        {
+            if (val_host_create_aux_rtt_levels(realm, ipa, RMI_INDEX(cmd_ret.x0),
+                                               VAL_RTT_MAX_LEVEL, PAGE_SIZE, index))
+            {
+                LOG(ERROR, "val_host_create_aux_rtt_levels failed, ipa=0x%x\n", ipa);
+                goto error;
+            }
+
+            cmd_ret = val_host_rmi_rtt_aux_map_protected(realm->rd, ipa, index);
+        }
+
+        if (cmd_ret.x0)
+        {
+            LOG(ERROR, "RTT_AUX_MAP_PROTECTED failed, ipa=0x%x, ret=0x%x\n", ipa, cmd_ret.x0);
+            goto error;
+        }
+    }
+
+    return VAL_SUCCESS;
+
+error:
+    while (ipa > base)
+    {
+        ipa -= PAGE_SIZE;
+        cmd_ret = val_host_rmi_rtt_aux_unmap_protected(realm->rd, ipa, index);
+        if (cmd_ret.x0)
+            LOG(ERROR, "val_rmi_rtt_aux_unmap_protected failed, ret=0x%x\n", cmd_ret.x0);
+    }
+
+    return VAL_ERROR;
+}
+
+/**
+ *   @brief    Maps a range of protected memory of the realm in all its
+ *             auxiliary RTTs, one plane after the other
+ *   @param    realm        - Realm strucrure
+ *   @param    base         - Base of the IPA range
+ *   @param    top          - Top of the IPA range, exclusive
+ *   @return   SUCCESS/FAILURE
+**/
+static uint32_t val_host_aux_map_protected_planes(val_host_realm_ts *realm, uint64_t base,
+                                                  uint64_t top)
+{
+    uint64_t j;
+
+    /* Only realms configured to use RTT tree per plane have auxiliary RTTs */
+    if (!(VAL_EXTRACT_BITS(realm->flags1, 0, 0) && realm->num_aux_planes > 0))
+        return VAL_SUCCESS;
+
+    for (j = 0; j < realm->num_aux_planes; j++)
+    {
+        if (val_host_aux_map_protected_range(realm, base, top, j + 1))
+        {
+            LOG(ERROR, "Aux plane %d mapping failed, ipa=0x%x\n", j + 1, base);
+            return VAL_ERROR;
+        }
+    }
+
+    return VAL_SUCCESS;
+}
+
 /**
  *   @brief    Creates a mapping from an Unprotected IPA to a Non-secure PA
  *   @param    realm            - Realm strucrure
@@ -625,48 +1054,312 @@ uint32_t val_host_map_unprotected_attr(val_host_realm_ts *realm,
 }
 
 /**
- *   @brief    Creates realm
- *   @param    realm            - Realm strucrure
- *   @return   SUCCESS/FAILURE
+ *   @brief    Clear the fields of realm params populated by the realm create
+ *             helpers, leaving the scratch page zero for the next user
+ *   @param    params           - Realm params in the scratch page
+ *   @return   void
 **/
-uint32_t val_host_realm_create(val_host_realm_ts *realm)
+void val_host_realm_params_reset(val_host_realm_params_ts *params)
 {
-    val_host_realm_params_ts *params;
-    uint64_t ret, i, j;
+    params->flags = 0;
+    params->s2sz = 0;
+    params->sve_vl = 0;
+    params->num_bps = 0;
+    params->num_wps = 0;
+    params->pmu_num_ctrs = 0;
+    params->hash_algo = 0;
+    params->num_aux_planes = 0;
+    params->vmid = 0;
+    params->rtt_base = 0;
+    params->rtt_level_start = 0;
+    params->rtt_num_start = 0;
+    params->flags1 = 0;
+    params->mecid = 0;
+    val_memset(params->rpv, 0, sizeof(params->rpv));
+    val_memset(params->aux_vmid, 0, sizeof(params->aux_vmid));
+    val_memset(params->aux_rtt_base, 0, sizeof(params->aux_rtt_base));
+}
 
-    realm->image_pa_size = PLATFORM_REALM_IMAGE_SIZE;
+/**
+ *   @brief    Clear the fields of REC params populated by the REC create
+ *             helpers, leaving the scratch page zero for the next user
+ *   @param    params           - REC params in the scratch page
+ *   @return   void
+**/
+void val_host_rec_params_reset(val_host_rec_params_ts *params)
+{
+    uint64_t i;
 
-    realm->state = REALM_STATE_NULL;
+    for (i = 0; i < params->num_aux && i < VAL_MAX_REC_AUX_GRANULES; i++)
+        params->aux[i] = 0;
 
-    /* Allocate memory for P0 image. Granule delegation
-     * for it will be performed during rtt creation.  */
-    realm->image_pa_base = (uint64_t)val_host_mem_alloc(PAGE_SIZE, realm->image_pa_size);
-    if (!realm->image_pa_base)
+    params->flags = 0;
+    params->mpidr = 0;
+    params->pc = 0;
+    params->num_aux = 0;
+}
+
+/**
+ *   @brief    Allocate the REC, run and mapped region storage of a realm from
+ *             the host heap. REC slots are sized by realm->rec_count.
+ *   @param    realm     - Realm structure
+ *   @return   SUCCESS/FAILURE
+**/
+uint32_t val_host_realm_storage_alloc(val_host_realm_ts *realm)
+{
+    realm->rec_slots = 0;
+    realm->rec = NULL;
+    realm->run = NULL;
+    realm->rec_aux_slots = 0;
+    realm->rec_aux_granules = NULL;
+    realm->granules_mapped_count = 0;
+
+    realm->granules = val_host_mem_alloc_tag(sizeof(uint64_t),
+                      VAL_HOST_GRANULES_MAP_MIN * sizeof(val_host_granules_mapped_ts),
+                      VAL_HOST_MEM_TAG_REALM);
+    if (realm->granules == NULL)
     {
-        LOG(ERROR, "val_host_mem_alloc failed, base=0x%x, size=0x%x\n",
-                realm->image_pa_base, realm->image_pa_size);
+        LOG(ERROR, "Failed to allocate mapped region storage\n");
+        realm->granules_mapped_slots = 0;
         return VAL_ERROR;
     }
+    realm->granules_mapped_slots = VAL_HOST_GRANULES_MAP_MIN;
 
-    /* Allocate memory for images of auxiliary planes */
-    for (i = 0; i < realm->num_aux_planes; i++)
+    return val_host_realm_rec_storage_reserve(realm, realm->rec_count, 0);
+}
+
+/**
+ *   @brief    Free the REC, run and mapped region storage of a realm. Called once
+ *             the realm is destroyed or its creation failed.
+ *   @param    realm     - Realm structure
+ *   @return   void
+**/
+void val_host_realm_storage_free(val_host_realm_ts *realm)
+{
+    val_host_mem_free(realm->rec);
+    val_host_mem_free(realm->run);
+    val_host_mem_free(realm->rec_aux_granules);
+    val_host_mem_free(realm->granules);
+
+    realm->rec_slots = 0;
+    realm->rec = NULL;
+    realm->run = NULL;
+    realm->rec_aux_slots = 0;
+    realm->rec_aux_granules = NULL;
+    realm->granules_mapped_slots = 0;
+    realm->granules_mapped_count = 0;
+    realm->granules = NULL;
+}
+
+/**
+ *   @brief    Grow a heap array of 64-bit entries, keeping its content
+ *   @param    array     - Array pointer, updated on success
+ *   @param    used      - Number of entries to keep
+ *   @param    count     - New number of entries
+ *   @return   SUCCESS/FAILURE
+**/
+static uint32_t val_host_realm_array_grow(uint64_t **array, uint64_t used, uint64_t count)
+{
+    uint64_t *new_array;
+
+    new_array = val_host_mem_alloc_tag(sizeof(uint64_t), count * sizeof(uint64_t),
+                                       VAL_HOST_MEM_TAG_REALM);
+    if (new_array == NULL)
+        return VAL_ERROR;
+
+    val_memset(new_array, 0, count * sizeof(uint64_t));
+    if (*array != NULL)
     {
-        realm->aux_image_pa_base[i] = (uint64_t)val_host_mem_alloc(PAGE_SIZE, realm->image_pa_size);
-        if (!realm->aux_image_pa_base[i])
-        {
-            LOG(ERROR, "val_host_mem_alloc failed, base=0x%x, size=0x%x\n",
-                 realm->aux_image_pa_base[i], realm->image_pa_size);
-            return VAL_ERROR;
-        }
+        val_memcpy(new_array, *array, used * sizeof(uint64_t));
+        val_host_mem_free(*array);
     }
 
-    /* Allocate and delegate RTT */
-    realm->rtt_l0_addr = (uint64_t)val_host_mem_alloc((realm->num_s2_sl_rtts * PAGE_SIZE),
-                                                    (realm->num_s2_sl_rtts * PAGE_SIZE));
-    if (!realm->rtt_l0_addr)
-    {
+    *array = new_array;
+    return VAL_SUCCESS;
+}
+
+/**
+ *   @brief    Make room for RECs and their auxiliary granules in a realm
+ *   @param    realm     - Realm structure
+ *   @param    rec_count - Number of RECs
+ *   @param    aux_count - Number of auxiliary granules per REC
+ *   @return   SUCCESS/FAILURE
+**/
+uint32_t val_host_realm_rec_storage_reserve(val_host_realm_ts *realm, uint64_t rec_count,
+                                            uint64_t aux_count)
+{
+    uint64_t slots = (rec_count > VAL_HOST_REC_SLOTS_MIN) ? rec_count : VAL_HOST_REC_SLOTS_MIN;
+
+    if (realm->rec_slots < rec_count || realm->rec == NULL)
+    {
+        if (val_host_realm_array_grow(&realm->rec, realm->rec_slots, slots) ||
+            val_host_realm_array_grow(&realm->run, realm->rec_slots, slots))
+        {
+            LOG(ERROR, "Failed to allocate storage for %d RECs\n", rec_count);
+            return VAL_ERROR;
+        }
+        realm->rec_slots = slots;
+    }
+
+    if (realm->rec_aux_slots < (rec_count * aux_count))
+    {
+        if (val_host_realm_array_grow(&realm->rec_aux_granules, realm->rec_aux_slots,
+                                      rec_count * aux_count))
+        {
+            LOG(ERROR, "Failed to allocate storage for %d REC aux granules\n",
+                                                        rec_count * aux_count);
+            return VAL_ERROR;
+        }
+        realm->rec_aux_slots = rec_count * aux_count;
+    }
+
+    return VAL_SUCCESS;
+}
+
+/**
+ *   @brief    Record a mapped region of a realm, doubling the region storage
+ *             when it is full
+ *   @param    realm     - Realm structure
+ *   @param    ipa       - IPA of the region
+ *   @param    size      - Size of the region
+ *   @param    pa        - PA of the region
+ *   @return   SUCCESS/FAILURE
+**/
+uint32_t val_host_realm_granule_add(val_host_realm_ts *realm, uint64_t ipa,
+                                    uint64_t size, uint64_t pa)
+{
+    val_host_granules_mapped_ts *granules;
+    uint64_t slots;
+
+    if (realm->granules_mapped_count == realm->granules_mapped_slots)
+    {
+        slots = realm->granules_mapped_slots ? (realm->granules_mapped_slots * 2) :
+                                                VAL_HOST_GRANULES_MAP_MIN;
+        granules = val_host_mem_alloc_tag(sizeof(uint64_t),
+                                          slots * sizeof(val_host_granules_mapped_ts),
+                                          VAL_HOST_MEM_TAG_REALM);
+        if (granules == NULL)
+        {
+            LOG(ERROR, "Failed to grow mapped region storage to %d\n", slots);
+            return VAL_ERROR;
+        }
+
+        if (realm->granules != NULL)
+        {
+            val_memcpy(granules, realm->granules,
+                       realm->granules_mapped_count * sizeof(val_host_granules_mapped_ts));
+            val_host_mem_free(realm->granules);
+        }
+        realm->granules = granules;
+        realm->granules_mapped_slots = slots;
+    }
+
+    realm->granules[realm->granules_mapped_count].ipa = ipa;
+    realm->granules[realm->granules_mapped_count].size = size;
+    realm->granules[realm->granules_mapped_count].level = VAL_RTT_MAX_LEVEL;
+    realm->granules[realm->granules_mapped_count].pa = pa;
+    realm->granules_mapped_count++;
+
+    return VAL_SUCCESS;
+}
+
+/**
+ *   @brief    Get the extent of the realm image from the header recorded in it
+ *             at link time. The whole of PLATFORM_REALM_IMAGE_SIZE is loaded
+ *             if the image has no valid header.
+ *   @param    realm            - Realm strucrure
+ *   @return   void
+**/
+static void val_host_realm_image_extent(val_host_realm_ts *realm)
+{
+    val_host_realm_image_header_ts *header = (val_host_realm_image_header_ts *)
+                        (PLATFORM_REALM_IMAGE_BASE + VAL_REALM_IMAGE_HEADER_OFFSET);
+
+    realm->image_pa_size = PLATFORM_REALM_IMAGE_SIZE;
+    realm->image_load_size = PLATFORM_REALM_IMAGE_SIZE;
+
+    if ((header->magic != VAL_REALM_IMAGE_MAGIC) ||
+        !ADDR_IS_ALIGNED(header->load_size, PAGE_SIZE) ||
+        !ADDR_IS_ALIGNED(header->image_size, PAGE_SIZE) ||
+        (header->load_size > header->image_size) ||
+        (header->image_size > PLATFORM_REALM_IMAGE_SIZE))
+    {
+        LOG(WARN, "No valid realm image header, mapping 0x%x bytes\n", realm->image_pa_size);
+        return;
+    }
+
+    realm->image_pa_size = header->image_size;
+    realm->image_load_size = header->load_size;
+}
+
+/**
+ *   @brief    Undelegate the granules of a starting level RTT allocation and
+ *             free it. Granules which weren't delegated yet fail to undelegate.
+ *   @param    rtt              - Base of the allocation, nothing is done if zero
+ *   @param    count            - Number of granules
+ *   @return   void
+**/
+static void val_host_realm_rtt_release(uint64_t rtt, uint64_t count)
+{
+    uint64_t i;
+
+    if (!rtt)
+        return;
+
+    for (i = 0; i < count; i++)
+        val_host_rmi_granule_undelegate(rtt + (i * PAGE_SIZE));
+
+    val_host_mem_free((void *)rtt);
+}
+
+/**
+ *   @brief    Creates realm
+ *   @param    realm            - Realm strucrure
+ *   @return   SUCCESS/FAILURE
+**/
+uint32_t val_host_realm_create(val_host_realm_ts *realm)
+{
+    val_host_realm_params_ts *params;
+    uint64_t ret, i, j;
+
+    val_host_realm_image_extent(realm);
+
+    realm->state = REALM_STATE_NULL;
+
+    if (val_host_realm_storage_alloc(realm))
+        goto free_storage;
+
+    /* Allocate memory for P0 image. Granule delegation
+     * for it will be performed during rtt creation.  */
+    realm->image_pa_base = (uint64_t)val_host_mem_alloc(PAGE_SIZE, realm->image_pa_size);
+    if (!realm->image_pa_base)
+    {
+        LOG(ERROR, "val_host_mem_alloc failed, base=0x%x, size=0x%x\n",
+                realm->image_pa_base, realm->image_pa_size);
+        goto free_storage;
+    }
+
+    /* Allocate memory for images of auxiliary planes */
+    val_memset(realm->aux_image_pa_base, 0, sizeof(realm->aux_image_pa_base));
+    val_memset(realm->rtt_aux_l0_addr, 0, sizeof(realm->rtt_aux_l0_addr));
+    for (i = 0; i < realm->num_aux_planes; i++)
+    {
+        realm->aux_image_pa_base[i] = (uint64_t)val_host_mem_alloc(PAGE_SIZE, realm->image_pa_size);
+        if (!realm->aux_image_pa_base[i])
+        {
+            LOG(ERROR, "val_host_mem_alloc failed, base=0x%x, size=0x%x\n",
+                 realm->aux_image_pa_base[i], realm->image_pa_size);
+            goto free_image;
+        }
+    }
+
+    /* Allocate and delegate RTT */
+    realm->rtt_l0_addr = (uint64_t)val_host_mem_alloc((realm->num_s2_sl_rtts * PAGE_SIZE),
+                                                    (realm->num_s2_sl_rtts * PAGE_SIZE));
+    if (!realm->rtt_l0_addr)
+    {
         LOG(ERROR, "Failed to allocate memory for rtt_addr\n");
-        goto undelegate_rd;
+        goto free_image;
     } else {
         for (i = 0; i < realm->num_s2_sl_rtts; i++)
         {
@@ -691,7 +1384,7 @@ uint32_t val_host_realm_create(val_host_realm_ts *realm)
             if (!realm->rtt_aux_l0_addr[i])
             {
                 LOG(ERROR, "Failed to allocate memory for rtt_addr\n");
-                goto undelegate_rd;
+                goto free_rtt;
             } else {
                 for (j = 0; j < realm->num_s2_sl_rtts; j++)
                 {
@@ -708,30 +1401,21 @@ uint32_t val_host_realm_create(val_host_realm_ts *realm)
         }
     }
 
-    /* Allocate and delegate RD */
-    realm->rd = (uint64_t)val_host_mem_alloc(PAGE_SIZE, PAGE_SIZE);
+    /* Get delegated RD */
+    realm->rd = val_host_granule_pool_get(PAGE_SIZE);
     if (!realm->rd)
     {
-        LOG(ERROR, "Failed to allocate memory for rd\n");
-        goto free_par;
-    } else {
-        ret = val_host_rmi_granule_delegate(realm->rd);
-        if (ret)
-        {
-            LOG(ERROR, "rd delegation failed, rd=0x%x, ret=0x%x\n", realm->rd, ret);
-            goto free_rd;
-        }
+        LOG(ERROR, "Failed to get delegated granule for rd\n");
+        goto free_rtt;
     }
 
-    /* Allocate memory for params */
-    params = val_host_mem_alloc(PAGE_SIZE, PAGE_SIZE);
-
+    /* Get zeroed scratch page for params */
+    params = val_host_scratch_page_get();
     if (params == NULL)
     {
         LOG(ERROR, "Failed to allocate memory for params\n");
-        goto undelegate_rtt;
+        goto put_rd;
     }
-    val_memset(params, 0, PAGE_SIZE_4K);
 
     /* Populate params */
     params->flags = realm->flags;
@@ -769,80 +1453,74 @@ uint32_t val_host_realm_create(val_host_realm_ts *realm)
 
     realm->state = REALM_STATE_NEW;
 
-    /* Free params */
-    val_host_mem_free(params);
+    val_host_realm_params_reset(params);
     return VAL_SUCCESS;
 
 free_params:
-    val_host_mem_free(params);
-
-undelegate_rtt:
-    ret = val_host_rmi_granule_undelegate(realm->rtt_l0_addr);
-    if (ret)
-    {
-        LOG(WARN, "rtt undelegation failed, rtt_addr=0x%x, ret=0x%x\n", realm->rtt_l0_addr, ret);
-    }
+    val_host_realm_params_reset(params);
 
-    if (VAL_EXTRACT_BITS(realm->flags1, 0, 0) && realm->num_aux_planes > 0)
+put_rd:
+    if (val_host_granule_pool_put(realm->rd))
     {
-        for (i = 0; i < realm->num_aux_planes; i++)
-        {
-            ret = val_host_rmi_granule_undelegate(realm->rtt_aux_l0_addr[i]);
-            if (ret)
-            {
-                LOG(WARN, " Aux RTT undelegation failed, rtt_addr=0x%x, ret=0x%x\n",
-                                                                   realm->rtt_aux_l0_addr[i], ret);
-            }
-        }
+        LOG(WARN, "rd release failed, rd=0x%x\n", realm->rd);
     }
+    realm->rd = 0;
 
 free_rtt:
-    val_host_mem_free((void *)realm->rtt_l0_addr);
-
-    if (VAL_EXTRACT_BITS(realm->flags1, 0, 0) && realm->num_aux_planes > 0)
-    {
-        for (uint64_t i = 0; i < realm->num_aux_planes; i++)
-            val_host_mem_free((void *)realm->rtt_aux_l0_addr[i]);
-    }
-
-undelegate_rd:
-    ret = val_host_rmi_granule_undelegate(realm->rd);
-    if (ret)
-    {
-        LOG(WARN, "rd undelegation failed, rd=0x%x, ret=0x%x\n", realm->rd, ret);
-    }
-free_rd:
-    val_host_mem_free((void *)realm->rd);
+    val_host_realm_rtt_release(realm->rtt_l0_addr, realm->num_s2_sl_rtts);
+    for (i = 0; i < realm->num_aux_planes; i++)
+        val_host_realm_rtt_release(realm->rtt_aux_l0_addr[i], realm->num_s2_sl_rtts);
 
-free_par:
+free_image:
     val_host_mem_free((void *)realm->image_pa_base);
-    for (uint64_t i = 0; i < realm->num_aux_planes; i++)
+    for (i = 0; i < realm->num_aux_planes; i++)
         val_host_mem_free((void *)realm->aux_image_pa_base[i]);
 
+free_storage:
+    val_host_realm_storage_free(realm);
+
     return VAL_ERROR;
 }
 
 /**
- *   @brief    Set the RIPAS of a target IPA range to RAM
+ *   @brief    Set the RIPAS of a target IPA range to RAM. Each subrange is
+ *             initialised at the coarsest level its alignment allows, tables
+ *             are only created one level down where a range boundary cuts an
+ *             entry.
  *   @param    realm            - Realm strucrure
  *   @param    base             - Base of target IPA region
  *   @param    top              - Top of target IPA region
- *   @param    rtt_level        - RTT level
+ *   @param    rtt_level        - Deepest level of the RTTs which can be created
  *   @param    rtt_alignment    - RTT Address Alignment
  *   @return   SUCCESS/FAILURE
 **/
 int val_host_ripas_init(val_host_realm_ts *realm, uint64_t base,
                 uint64_t top, uint64_t rtt_level, uint64_t rtt_alignment)
 {
-    uint64_t ret = 0, out_top, rtt_level1;
+    uint64_t ret = 0, out_top, rtt_level1, walk_level;
     val_host_rtt_entry_ts rtte;
 
-    do
+    while (base < top)
     {
+        /* Split the entry cut by the range from the shadow, so that
+           RTT_INIT_RIPAS doesn't fail */
+        if (!val_host_rtt_shadow_level(realm->rd, base, rtt_level, &walk_level))
+        {
+            while ((walk_level < rtt_level) &&
+                   (!ADDR_IS_ALIGNED(base, val_host_rtt_level_mapsize(walk_level)) ||
+                    (base + val_host_rtt_level_mapsize(walk_level) > top)))
+            {
+                if (val_host_create_rtt_levels(realm, base, walk_level, walk_level + 1,
+                                                                        rtt_alignment))
+                    return VAL_ERROR;
+                walk_level++;
+            }
+        }
+
         ret = val_host_rmi_rtt_init_ripas(realm->rd, base, top, &out_top);
         rtt_level1 = RMI_INDEX(ret);
 
-        if (RMI_STATUS(ret) == RMI_ERROR_RTT && rtt_level1 < VAL_RTT_MAX_LEVEL)
+        if (RMI_STATUS(ret) == RMI_ERROR_RTT && rtt_level1 < rtt_level)
         {
             ret = val_host_rmi_rtt_read_entry(realm->rd,
                         val_host_addr_align_to_level(base, rtt_level1), rtt_level1, &rtte);
@@ -854,8 +1532,9 @@ int val_host_ripas_init(val_host_realm_ts *realm, uint64_t base,
 
             if (rtte.state == RMI_UNASSIGNED)
             {
+                /* The entry covers more than the range, split it by one level */
                 ret = val_host_create_rtt_levels(realm, base, rtte.walk_level,
-                                                rtt_level, rtt_alignment);
+                                                rtte.walk_level + 1, rtt_alignment);
                 if (ret)
                 {
                     return VAL_ERROR;
@@ -868,7 +1547,9 @@ int val_host_ripas_init(val_host_realm_ts *realm, uint64_t base,
         {
             return VAL_ERROR;
         }
-    } while (out_top != top);
+
+        base = out_top;
+    }
 
     return VAL_SUCCESS;
 }
@@ -881,54 +1562,20 @@ int val_host_ripas_init(val_host_realm_ts *realm, uint64_t base,
 static uint32_t val_host_image_map(val_host_realm_ts *realm, uint64_t ipa_base, uint64_t pa_base)
 {
     uint64_t src_pa = PLATFORM_REALM_IMAGE_BASE;
-    uint32_t i = 0, j = 0;
 
-    if (val_host_ripas_init(realm,
-            ipa_base,
-            ipa_base + realm->image_pa_size,
-            VAL_RTT_MAX_LEVEL, PAGE_SIZE))
+    /* MAP image regions, bss and translation tables are cleared by the realm */
+    if (val_host_map_protected_range(realm, pa_base, ipa_base, ipa_base + realm->image_load_size,
+                                     ipa_base + realm->image_pa_size, src_pa, PAGE_SIZE))
     {
-        LOG(ERROR, "realm_init_ipa_state failed, ipa=0x%x\n",
-                ipa_base + i * PAGE_SIZE);
+        LOG(ERROR, "val_host_map_protected_range failed, pa_base=0x%x\n", pa_base);
         return VAL_ERROR;
     }
-    /* MAP image regions */
-    while (i < (realm->image_pa_size/PAGE_SIZE))
-    {
-        if (val_host_map_protected_data(realm,
-                pa_base + i * PAGE_SIZE,
-                ipa_base + i * PAGE_SIZE,
-                PAGE_SIZE,
-                src_pa + i * PAGE_SIZE
-                ))
-        {
-            LOG(ERROR, "val_realm_map_protected_data failed, par_base=0x%x\n",
-                    pa_base);
-            return VAL_ERROR;
-        }
 
-        /* If Realm is configured to use RTT tree per plane, map auxillary RTTs as well */
-        if (VAL_EXTRACT_BITS(realm->flags1, 0, 0) && realm->num_aux_planes > 0)
-        {
-            for (j = 0; j < realm->num_aux_planes ; j++)
-            {
-                if (val_host_aux_map_protected_data(realm, ipa_base + i * PAGE_SIZE, j + 1))
-                {
-                    LOG(ERROR, "val_realm_aux_map_protected_data failed, ipa=0x%x\n",
-                                                             ipa_base + i * PAGE_SIZE);
-                    return VAL_ERROR;
-                }
-            }
-        }
+    /* If Realm is configured to use RTT tree per plane, map auxillary RTTs as well */
+    if (val_host_aux_map_protected_planes(realm, ipa_base, ipa_base + realm->image_pa_size))
+        return VAL_ERROR;
 
-        i++;
-    }
-    realm->granules[realm->granules_mapped_count].ipa = ipa_base;
-    realm->granules[realm->granules_mapped_count].size = realm->image_pa_size;
-    realm->granules[realm->granules_mapped_count].level = VAL_RTT_MAX_LEVEL;
-    realm->granules[realm->granules_mapped_count].pa = pa_base;
-    realm->granules_mapped_count++;
-    return VAL_SUCCESS;
+    return val_host_realm_granule_add(realm, ipa_base, realm->image_pa_size, pa_base);
 }
 /**
  *   @brief    Maps protected memory into the realm
@@ -939,55 +1586,32 @@ static uint32_t val_host_image_map(val_host_realm_ts *realm, uint64_t ipa_base,
 uint32_t val_host_map_protected_data_to_realm(val_host_realm_ts *realm,
                                             val_data_create_ts *data_create)
 {
-    uint32_t i = 0, j;
-
-    if (val_host_ripas_init(realm,
-            data_create->ipa,
-            data_create->ipa + data_create->size,
-            VAL_RTT_MAX_LEVEL, data_create->rtt_alignment))
-    {
-        LOG(ERROR, "val_host_ripas_init failed, ipa=0x%x\n",
-                data_create->ipa + i * PAGE_SIZE);
-        return VAL_ERROR;
-    }
-    /* MAP image regions */
-    while (i < (data_create->size/PAGE_SIZE))
+    /* MAP image regions, large ranges on all the cpus if asked to */
+    if ((populate_mode == VAL_HOST_POPULATE_PARALLEL) &&
+        (data_create->size >= VAL_HOST_POPULATE_SPLIT_MIN * VAL_RTT_L2_BLOCK_SIZE))
     {
-        if (val_host_map_protected_data(realm,
-                data_create->target_pa + i * PAGE_SIZE,
-                data_create->ipa + i * PAGE_SIZE,
-                PAGE_SIZE,
-                data_create->src_pa + i * PAGE_SIZE
-                ))
+        if (val_host_map_protected_data_parallel(realm, data_create))
         {
-            LOG(ERROR, "val_realm_map_protected_data failed, par_base=0x%x\n",
+            LOG(ERROR, "val_host_map_protected_data_parallel failed, par_base=0x%x\n",
                     data_create->target_pa);
             return VAL_ERROR;
         }
-
-        /* If Realm is configured to use RTT tree per plane, map auxillary RTTs as well */
-        if (VAL_EXTRACT_BITS(realm->flags1, 0, 0) && realm->num_aux_planes > 0)
-        {
-            for (j = 0; j < realm->num_aux_planes ; j++)
-            {
-                if (val_host_aux_map_protected_data(realm, data_create->ipa + i * PAGE_SIZE, j + 1))
-                {
-                    LOG(ERROR, "val_realm_aux_map_protected_data failed, ipa=0x%x\n",
-                                                             data_create->ipa + i * PAGE_SIZE);
-                    return VAL_ERROR;
-                }
-            }
-        }
-
-        i++;
+    }
+    else if (val_host_map_protected_data_range(realm, data_create->target_pa, data_create->ipa,
+                                          data_create->ipa + data_create->size,
+                                          data_create->src_pa, data_create->rtt_alignment))
+    {
+        LOG(ERROR, "val_host_map_protected_data_range failed, par_base=0x%x\n",
+                data_create->target_pa);
+        return VAL_ERROR;
     }
 
-    realm->granules[realm->granules_mapped_count].ipa = data_create->ipa;
-    realm->granules[realm->granules_mapped_count].size = data_create->size;
-    realm->granules[realm->granules_mapped_count].level = VAL_RTT_MAX_LEVEL;
-    realm->granules[realm->granules_mapped_count].pa = data_create->target_pa;
-    realm->granules_mapped_count++;
-    return VAL_SUCCESS;
+    /* If Realm is configured to use RTT tree per plane, map auxillary RTTs as well */
+    if (val_host_aux_map_protected_planes(realm, data_create->ipa,
+                                          data_create->ipa + data_create->size))
+        return VAL_ERROR;
+
+    return val_host_realm_granule_add(realm, data_create->ipa, data_create->size, data_create->target_pa);
 }
 
 /**
@@ -1032,12 +1656,8 @@ static uint32_t val_host_map_shared_region(val_host_realm_ts *realm)
 
         i++;
     }
-    realm->granules[realm->granules_mapped_count].ipa = ns_shared_base_ipa;
-    realm->granules[realm->granules_mapped_count].size = PLATFORM_SHARED_REGION_SIZE;
-    realm->granules[realm->granules_mapped_count].level = VAL_RTT_MAX_LEVEL;
-    realm->granules[realm->granules_mapped_count].pa = ns_shared_base_pa;
-    realm->granules_mapped_count++;
-    return VAL_SUCCESS;
+    return val_host_realm_granule_add(realm, ns_shared_base_ipa, PLATFORM_SHARED_REGION_SIZE,
+                                      ns_shared_base_pa);
 }
 
 /**
@@ -1077,11 +1697,9 @@ uint32_t val_host_map_ns_shared_region(val_host_realm_ts *realm, uint64_t size,
         }
         i++;
     }
-    realm->granules[realm->granules_mapped_count].ipa = ns_shared_base_ipa;
-    realm->granules[realm->granules_mapped_count].size = size;
-    realm->granules[realm->granules_mapped_count].level = VAL_RTT_MAX_LEVEL;
-    realm->granules[realm->granules_mapped_count].pa = pa;
-    realm->granules_mapped_count++;
+    if (val_host_realm_granule_add(realm, ns_shared_base_ipa, size, pa))
+        return 0;
+
     return (uint32_t)(realm->granules_mapped_count - 1);
 }
 
@@ -1095,13 +1713,7 @@ uint32_t val_host_rec_create(val_host_realm_ts *realm)
     val_host_rec_params_ts   *rec_params;
     val_host_rec_create_flags_ts rec_create_flags;
 
-    uint64_t ret, i, mpidr = 0x0, aux_count, j;
-
-    if (realm->rec_count > VAL_MAX_REC_COUNT)
-    {
-        LOG(ERROR, "max supported recs are VAL_MAX_REC_COUNT\n");
-        return VAL_ERROR;
-    }
+    uint64_t ret, i, aux_count, j;
 
     /* Get aux granules count */
     ret = val_host_rmi_rec_aux_count(realm->rd, &aux_count);
@@ -1118,39 +1730,39 @@ uint32_t val_host_rec_create(val_host_realm_ts *realm)
 
     }
 
-    /* Allocate memory for rec_params */
-    rec_params = val_host_mem_alloc(PAGE_SIZE, PAGE_SIZE);
+    if (val_host_realm_rec_storage_reserve(realm, realm->rec_count, aux_count))
+        return VAL_ERROR;
+
+    /* Get zeroed scratch page for rec_params */
+    rec_params = val_host_scratch_page_get();
     if (rec_params == NULL)
     {
         LOG(ERROR, "Failed to allocate memory for rec_params\n");
         return VAL_ERROR;
     }
-    val_memset(rec_params, 0x0, PAGE_SIZE);
     val_memset(&rec_create_flags, 0, sizeof(rec_create_flags));
 
-    /* Populate rec_params */
+    /* Populate rec_params, gprs are left zero */
     rec_params->num_aux = aux_count;
     realm->aux_count = aux_count;
 
-    for (i = 0; i < (sizeof(rec_params->gprs)/sizeof(rec_params->gprs[0])); i++)
-    {
-        rec_params->gprs[i] = 0x0;
-    }
-
     rec_params->pc = VAL_PLANE0_IMAGE_BASE_IPA;
     rec_create_flags.runnable = RMI_RUNNABLE;
 
-    for (i = 0; i < realm->rec_count; i++, mpidr++)
+    for (i = 0; i < realm->rec_count; i++)
     {
+        realm->rec[i] = 0;
+        j = 0;
+
         /* Create all RECs except primary REC with NOT_RUNNABLE Flag */
         if (i != 0)
             rec_create_flags.runnable = RMI_NOT_RUNNABLE;
 
         val_memcpy(&rec_params->flags, &rec_create_flags, sizeof(rec_create_flags));
 
-        rec_params->mpidr = mpidr;
+        rec_params->mpidr = VAL_HOST_REC_MPIDR(i);
         /* Allocate memory for run object */
-        realm->run[i] = (uint64_t)val_host_mem_alloc(PAGE_SIZE, PAGE_SIZE);
+        realm->run[i] = (uint64_t)val_host_mem_alloc_tag(PAGE_SIZE, PAGE_SIZE, VAL_HOST_MEM_TAG_RUN);
         if (!realm->run[i])
         {
             LOG(ERROR, "Failed to allocate memory for run[%d]\n", i);
@@ -1158,38 +1770,24 @@ uint32_t val_host_rec_create(val_host_realm_ts *realm)
         }
         val_memset((void *)realm->run[i], 0x0, PAGE_SIZE);
 
-        /* Allocate and delegate REC */
-        realm->rec[i] = (uint64_t)val_host_mem_alloc(PAGE_SIZE, PAGE_SIZE);
+        /* Get delegated REC */
+        realm->rec[i] = val_host_granule_pool_get(PAGE_SIZE);
         if (!realm->rec[i])
         {
-            LOG(ERROR, "Failed to allocate memory for REC\n");
+            LOG(ERROR, "Failed to get delegated granule for REC\n");
             goto free_rec_params;
-        } else {
-            ret = val_host_rmi_granule_delegate(realm->rec[i]);
-            if (ret)
-            {
-                LOG(ERROR, "rec delegation failed, rec=0x%x, ret=0x%x\n", realm->rec[i], ret);
-                goto free_rec_params;
-            }
         }
 
         for (j = 0; j < aux_count; j++)
         {
-            rec_params->aux[j] = (uint64_t)val_host_mem_alloc(PAGE_SIZE, PAGE_SIZE);
+            rec_params->aux[j] = val_host_granule_pool_get(PAGE_SIZE);
             if (!rec_params->aux[j])
             {
-                LOG(ERROR, "Failed to allocate memory for aux rec\n");
+                LOG(ERROR, "Failed to get delegated granule for aux rec\n");
                 goto free_rec_params;
-            } else {
-                ret = val_host_rmi_granule_delegate(rec_params->aux[j]);
-                if (ret)
-                {
-                    LOG(ERROR, "rec delegation failed, rec=0x%x, ret=0x%x\n",
-                                         rec_params->aux[j], ret);
-                    goto free_rec_params;
-                }
             }
             realm->rec_aux_granules[j + (i * aux_count)] = rec_params->aux[j];
+            val_host_mem_set_tag(rec_params->aux[j], VAL_HOST_MEM_TAG_REC_AUX);
         }
 
         /* Create REC  */
@@ -1201,40 +1799,37 @@ uint32_t val_host_rec_create(val_host_realm_ts *realm)
         }
     }
 
-    /* Free rec_params */
-    val_host_mem_free(rec_params);
+    val_host_rec_params_reset(rec_params);
     return VAL_SUCCESS;
 
 free_rec_params:
-    while (i > 0)
+    /* REC i holds the granules got so far, the RECs before it were created */
+    while (j > 0)
+        val_host_granule_pool_put(rec_params->aux[--j]);
+    if (realm->rec[i])
+        val_host_granule_pool_put(realm->rec[i]);
+    val_host_mem_free((void *)realm->run[i]);
+    realm->rec[i] = 0;
+    realm->run[i] = 0;
+
+    while (i-- > 0)
     {
-        ret = val_host_rmi_granule_undelegate(realm->rec[i]);
+        ret = val_host_rmi_rec_destroy(realm->rec[i]);
         if (ret)
         {
-            LOG(WARN, "rec undelegation failed, rec=0x%x, ret=0x%x\n", realm->rec[i], ret);
+            LOG(WARN, "rec destroy failed, rec=0x%x, ret=0x%x\n", realm->rec[i], ret);
+            continue;
         }
 
-        val_host_mem_free((void *)realm->rec[i]);
-        val_host_mem_free((void *)realm->run[i]);
-
+        val_host_granule_pool_put(realm->rec[i]);
         for (j = 0; j < aux_count; j++)
-        {
-            ret = val_host_rmi_granule_undelegate(realm->rec_aux_granules[j + (i * aux_count)]);
-            if (ret)
-            {
-                LOG(WARN, "granule undelegation failed, PA=0x%x, ret=0x%x\n",
-                realm->rec_aux_granules[j + (i * aux_count)], ret);
-            }
-            val_host_mem_free((void *)realm->rec_aux_granules[j + (i * aux_count)]);
-        }
-        i--;
-        if (i == 0)
-        {
-            break;
-        }
+            val_host_granule_pool_put(realm->rec_aux_granules[j + (i * aux_count)]);
+        val_host_mem_free((void *)realm->run[i]);
+        realm->rec[i] = 0;
+        realm->run[i] = 0;
     }
 
-    val_host_mem_free(rec_params);
+    val_host_rec_params_reset(rec_params);
     return VAL_ERROR;
 }
 
@@ -1377,769 +1972,2418 @@ uint32_t val_host_check_realm_exit_psci(val_host_rec_run_ts *run, uint32_t psci_
 }
 
 /**
- *   @brief    Add granule to the NS mem track[0]
- *   @param    state      - state of granule
- *   @param    PA         - Physical address of granule
- *   @param    node       - node pointer
- *   @return   void
+ *   @brief    Get a mem_track node. Nodes are carved from heap pages, one per
+ *             cache line, and recycled through a free list.
+ *   @param    void
+ *   @return   Returns zeroed node on success, otherwise NULL
 **/
-void val_host_add_granule(uint32_t state, uint64_t PA, val_host_granule_ts *node)
+static val_host_granule_ts *val_host_track_node_alloc(void)
 {
-    val_host_granule_ts *granule_list;
+    val_host_granule_ts *node;
+    uint64_t i;
 
-    /* if node is null, create node and add to NS mem_track[0] list
-       else add node directly to the list */
-    if (node == NULL)
-    {
-        granule_list = (val_host_granule_ts *) mem_alloc(sizeof(val_host_granule_ts),
-                                                              sizeof(val_host_granule_ts));
-        granule_list->state = state;
-        granule_list->PA = PA;
-        granule_list->next = NULL;
-        granule_list->is_granule_sliced = 0;
-        granule_list->rtt_tree_idx = 0;
-        for (uint64_t i = 0; i < VAL_MAX_AUX_PLANES; i++)
-            granule_list->has_auxiliary[i] = 0;
-    } else
+    if (track_free_list == NULL)
     {
-        granule_list = node;
-    }
+        node = val_host_mem_alloc_tag(PAGE_SIZE, PAGE_SIZE, VAL_HOST_MEM_TAG_TRACK);
+        if (node == NULL)
+        {
+            LOG(ERROR, "Failed to allocate mem_track nodes\n");
+            return NULL;
+        }
 
-    if (head == NULL)
-    {
-        head = granule_list;
-        mem_track[0].gran_type.ns = head;
-        mem_track[0].gran_type.ns->next = NULL;
-        tail = granule_list;
-    } else
-    {
-        tail->next = granule_list;
-        tail = tail->next;
+        for (i = 0; i < VAL_HOST_TRACK_NODES_PER_PAGE; i++)
+        {
+            node[i].next = track_free_list;
+            track_free_list = &node[i];
+        }
     }
-}
+
+    node = track_free_list;
+    track_free_list = node->next;
+    val_memset(node, 0, sizeof(val_host_granule_ts));
+
+    return node;
+}
+
+/**
+ *   @brief    Return a mem_track node, which must be removed from its list
+ *   @param    node       - node pointer
+ *   @return   void
+**/
+static void val_host_track_node_free(val_host_granule_ts *node)
+{
+    node->next = track_free_list;
+    track_free_list = node;
+}
+
+static inline bool val_host_granule_map_covers(uint64_t PA)
+{
+    return (PA >= PLATFORM_MEMORY_POOL_BASE) &&
+           (PA < (PLATFORM_MEMORY_POOL_BASE + PLATFORM_MEMORY_POOL_SIZE));
+}
+
+/**
+ *   @brief    Get the granule map state of a PA of the memory pool
+ *   @param    PA         - Physical address of granule
+ *   @return   Returns VAL_HOST_GRANULE_MAP_* state
+**/
+static uint32_t val_host_granule_map_get(uint64_t PA)
+{
+    uint64_t granule = (PA - PLATFORM_MEMORY_POOL_BASE) >> VAL_HOST_GRANULE_MAP_SHIFT;
+    uint64_t shift = (granule % VAL_HOST_GRANULE_MAP_PER_WORD) * VAL_HOST_GRANULE_MAP_BITS;
+
+    return (granule_map[granule / VAL_HOST_GRANULE_MAP_PER_WORD] >> shift) &
+                                   ((1UL << VAL_HOST_GRANULE_MAP_BITS) - 1);
+}
+
+/**
+ *   @brief    Set the granule map state of a PA of the memory pool
+ *   @param    PA         - Physical address of granule
+ *   @param    state      - VAL_HOST_GRANULE_MAP_* state
+ *   @return   void
+**/
+static void val_host_granule_map_set(uint64_t PA, uint32_t state)
+{
+    uint64_t granule = (PA - PLATFORM_MEMORY_POOL_BASE) >> VAL_HOST_GRANULE_MAP_SHIFT;
+    uint64_t shift = (granule % VAL_HOST_GRANULE_MAP_PER_WORD) * VAL_HOST_GRANULE_MAP_BITS;
+    uint64_t *word = &granule_map[granule / VAL_HOST_GRANULE_MAP_PER_WORD];
+
+    *word &= ~(((1UL << VAL_HOST_GRANULE_MAP_BITS) - 1) << shift);
+    *word |= (uint64_t)state << shift;
+}
+
+static inline uint64_t val_host_granule_index_home(uint64_t PA)
+{
+    /* Multiplicative hash of the granule number */
+    return (((PA >> 12) * 0x9E3779B97F4A7C15ULL) >> 32) & (granule_index_slots - 1);
+}
+
+/**
+ *   @brief    Find the index slot holding the node of a PA
+ *   @param    PA         - Physical address of granule
+ *   @return   Returns slot index, or granule_index_slots if PA isn't indexed
+**/
+static uint64_t val_host_granule_index_lookup(uint64_t PA)
+{
+    uint64_t slot;
+
+    if (granule_index == NULL)
+        return granule_index_slots;
+
+    slot = val_host_granule_index_home(PA);
+    while (granule_index[slot] != NULL)
+    {
+        if (granule_index[slot]->PA == PA)
+            return slot;
+        slot = (slot + 1) & (granule_index_slots - 1);
+    }
+
+    return granule_index_slots;
+}
+
+static void val_host_granule_index_place(val_host_granule_ts *node)
+{
+    uint64_t slot = val_host_granule_index_home(node->PA);
+
+    while (granule_index[slot] != NULL)
+        slot = (slot + 1) & (granule_index_slots - 1);
+
+    granule_index[slot] = node;
+}
+
+/**
+ *   @brief    Add node to the PA index, doubling the index when it gets half full
+ *   @param    node       - node pointer
+ *   @return   Returns VAL_SUCCESS/VAL_ERROR
+**/
+static uint32_t val_host_granule_index_insert(val_host_granule_ts *node)
+{
+    val_host_granule_ts **old_index = granule_index;
+    uint64_t old_slots = granule_index_slots, i;
+
+    if ((granule_index_count + 1) * 2 > granule_index_slots)
+    {
+        granule_index_slots = old_slots ? old_slots * 2 : VAL_HOST_GRANULE_INDEX_MIN_SLOTS;
+        granule_index = val_host_mem_alloc_tag(PAGE_SIZE,
+                                 granule_index_slots * sizeof(val_host_granule_ts *),
+                                 VAL_HOST_MEM_TAG_TRACK);
+        if (granule_index == NULL)
+        {
+            LOG(ERROR, "Failed to grow mem_track index to %d slots\n", granule_index_slots);
+            granule_index = old_index;
+            granule_index_slots = old_slots;
+            return VAL_ERROR;
+        }
+        val_memset(granule_index, 0, granule_index_slots * sizeof(val_host_granule_ts *));
+
+        for (i = 0; i < old_slots; i++)
+        {
+            if (old_index[i] != NULL)
+                val_host_granule_index_place(old_index[i]);
+        }
+        val_host_mem_free(old_index);
+    }
+
+    val_host_granule_index_place(node);
+    granule_index_count++;
+
+    return VAL_SUCCESS;
+}
+
+/**
+ *   @brief    Remove the node in an index slot. Following nodes of the probe
+ *             sequence are shifted back so that lookups need no tombstones.
+ *   @param    slot       - Slot returned by val_host_granule_index_lookup
+ *   @return   void
+**/
+static void val_host_granule_index_remove(uint64_t slot)
+{
+    uint64_t mask = granule_index_slots - 1, next = slot, home;
+
+    granule_index[slot] = NULL;
+    granule_index_count--;
+
+    while (1)
+    {
+        next = (next + 1) & mask;
+        if (granule_index[next] == NULL)
+            return;
+
+        /* Move the node to the hole unless its home lies cyclically in (slot, next] */
+        home = val_host_granule_index_home(granule_index[next]->PA);
+        if (((next - home) & mask) >= ((next - slot) & mask))
+        {
+            granule_index[slot] = granule_index[next];
+            granule_index[next] = NULL;
+            slot = next;
+        }
+    }
+}
+
+static inline uint64_t val_host_ipa_index_entry(uint64_t ipa, uint32_t level)
+{
+    return ((ipa / PAGE_SIZE) >> (VAL_HOST_IPA_INDEX_BITS * (VAL_HOST_IPA_INDEX_LEVELS - 1 - level)))
+                                                            & (VAL_HOST_IPA_INDEX_ENTRIES - 1);
+}
+
+static val_host_ipa_table_ts *val_host_ipa_table_alloc(void)
+{
+    val_host_ipa_table_ts *table;
+
+    table = val_host_mem_alloc_tag(PAGE_SIZE, sizeof(val_host_ipa_table_ts), VAL_HOST_MEM_TAG_TRACK);
+    if (table != NULL)
+        val_memset(table, 0, sizeof(val_host_ipa_table_ts));
+
+    return table;
+}
+
+/**
+ *   @brief    Add node to the IPA index of a list
+ *   @param    gran_list  - granule list
+ *   @param    node       - node pointer
+ *   @return   Returns VAL_SUCCESS/VAL_ERROR
+**/
+static uint32_t val_host_ipa_index_insert(val_host_granule_list_ts *gran_list,
+                                          val_host_granule_ts *node)
+{
+    val_host_ipa_table_ts *table;
+    uint64_t entry;
+    uint32_t level;
+
+    if (gran_list->ipa_root == NULL)
+    {
+        gran_list->ipa_root = val_host_ipa_table_alloc();
+        if (gran_list->ipa_root == NULL)
+            return VAL_ERROR;
+    }
+
+    table = gran_list->ipa_root;
+    for (level = 0; level < VAL_HOST_IPA_INDEX_LEVELS - 1; level++)
+    {
+        entry = val_host_ipa_index_entry(node->ipa, level);
+        if (table->entry[entry] == NULL)
+        {
+            table->entry[entry] = val_host_ipa_table_alloc();
+            if (table->entry[entry] == NULL)
+                return VAL_ERROR;
+        }
+        table = table->entry[entry];
+    }
+
+    table->entry[val_host_ipa_index_entry(node->ipa, level)] = node;
+    return VAL_SUCCESS;
+}
+
+/**
+ *   @brief    Get the leaf entry of an IPA in the IPA index of a list
+ *   @param    gran_list  - granule list
+ *   @param    ipa        - IPA of the granule
+ *   @return   Returns pointer to the leaf entry, or NULL if it doesn't exist
+**/
+static void **val_host_ipa_index_leaf(val_host_granule_list_ts *gran_list, uint64_t ipa)
+{
+    val_host_ipa_table_ts *table = gran_list->ipa_root;
+    uint32_t level;
+
+    for (level = 0; (table != NULL) && (level < VAL_HOST_IPA_INDEX_LEVELS - 1); level++)
+        table = table->entry[val_host_ipa_index_entry(ipa, level)];
+
+    if (table == NULL)
+        return NULL;
+
+    return &table->entry[val_host_ipa_index_entry(ipa, level)];
+}
+
+/**
+ *   @brief    Find the node with the lowest IPA not below ipa in a subtree
+ *   @param    table      - Table at the root of the subtree
+ *   @param    level      - Level of the table
+ *   @param    ipa        - Lowest IPA, 0 to search the whole subtree
+ *   @return   Returns the node, or NULL if there is none
+**/
+static val_host_granule_ts *val_host_ipa_index_next(val_host_ipa_table_ts *table,
+                                                    uint32_t level, uint64_t ipa)
+{
+    val_host_granule_ts *node;
+    uint64_t entry;
+
+    for (entry = val_host_ipa_index_entry(ipa, level); entry < VAL_HOST_IPA_INDEX_ENTRIES; entry++)
+    {
+        if (table->entry[entry] != NULL)
+        {
+            if (level == VAL_HOST_IPA_INDEX_LEVELS - 1)
+                return table->entry[entry];
+
+            node = val_host_ipa_index_next(table->entry[entry], level + 1, ipa);
+            if (node != NULL)
+                return node;
+        }
+        /* Following subtrees hold higher IPAs only */
+        ipa = 0;
+    }
+
+    return NULL;
+}
+
+/**
+ *   @brief    Append node to the end of a mem_track list
+ *   @param    gran_list  - granule list
+ *   @param    node       - node pointer
+ *   @return   void
+**/
+static void val_host_list_append(val_host_granule_list_ts *gran_list, val_host_granule_ts *node)
+{
+    node->next = NULL;
+    node->prev = gran_list->tail;
+
+    if (gran_list->tail == NULL)
+        gran_list->head = node;
+    else
+        gran_list->tail->next = node;
+
+    gran_list->tail = node;
+    gran_list->count++;
+
+    if (gran_list->ipa_indexed && val_host_ipa_index_insert(gran_list, node))
+    {
+        LOG(WARN, "Failed to index ipa=0x%x, falling back to list search\n", node->ipa);
+        gran_list->ipa_indexed = false;
+    }
+}
+
+/**
+ *   @brief    Unlink node from the mem_track list it belongs to
+ *   @param    gran_list  - granule list
+ *   @param    node       - node pointer
+ *   @return   void
+**/
+static void val_host_list_unlink(val_host_granule_list_ts *gran_list, val_host_granule_ts *node)
+{
+    void **leaf;
+
+    if (gran_list->ipa_indexed)
+    {
+        leaf = val_host_ipa_index_leaf(gran_list, node->ipa);
+        if ((leaf != NULL) && (*leaf == node))
+            *leaf = NULL;
+    }
+
+    if (node->prev != NULL)
+        node->prev->next = node->next;
+    else
+        gran_list->head = node->next;
+
+    if (node->next != NULL)
+        node->next->prev = node->prev;
+    else
+        gran_list->tail = node->prev;
+
+    node->next = NULL;
+    node->prev = NULL;
+    gran_list->count--;
+}
+
+/* Host shadow of the RTT tree of a realm. Each RTT above the last level has a
+ * shadow table whose entries point to the shadow of the RTTs one level down.
+ * Entries of level 2 shadows point to the tracking node of the L3 RTT. The
+ * starting level shadow spans all the concatenated starting level RTTs. */
+
+static inline uint64_t val_host_rtt_shadow_entry(val_host_memory_track_ts *track, uint64_t ipa,
+                                                 uint64_t level)
+{
+    if (level == track->rtt_level_start)
+        return (ipa & ((1UL << track->ipa_width) - 1)) >> VAL_RTT_LEVEL_SHIFT(level);
+
+    return (ipa >> VAL_RTT_LEVEL_SHIFT(level)) & (VAL_HOST_IPA_INDEX_ENTRIES - 1);
+}
+
+/**
+ *   @brief    Find the shadow of the RTT at a level which covers an IPA
+ *   @param    track      - mem_track entry of the realm
+ *   @param    ipa        - IPA
+ *   @param    level      - RTT level, below VAL_RTT_MAX_LEVEL
+ *   @return   Returns the shadow entries, NULL if there is no such RTT
+**/
+static void **val_host_rtt_shadow_table(val_host_memory_track_ts *track, uint64_t ipa,
+                                        uint64_t level)
+{
+    val_host_ipa_table_ts *child;
+    void **table = track->rtt_shadow;
+    uint64_t l;
+
+    for (l = track->rtt_level_start; (l < level) && (table != NULL); l++)
+    {
+        child = table[val_host_rtt_shadow_entry(track, ipa, l)];
+        table = (child == NULL) ? NULL : child->entry;
+    }
+
+    return table;
+}
+
+/**
+ *   @brief    Record a created RTT in the shadow of a realm. The shadow is
+ *             dropped if it can't be kept up to date.
+ *   @param    realm      - Realm index in mem track
+ *   @param    ipa        - Base IPA of the RTT
+ *   @param    level      - Level of the RTT
+ *   @param    node       - Tracking node of the RTT
+ *   @return   void
+**/
+static void val_host_rtt_shadow_add(int realm, uint64_t ipa, uint64_t level,
+                                    val_host_granule_ts *node)
+{
+    val_host_memory_track_ts *track = &mem_track[realm];
+    val_host_ipa_table_ts *child = NULL;
+    void **parent;
+    uint64_t entries;
+
+    if ((track->ipa_width == 0) || (track->rtt_level_start >= VAL_RTT_MAX_LEVEL) ||
+        (level <= track->rtt_level_start) || (level > VAL_RTT_MAX_LEVEL))
+        return;
+
+    if (track->rtt_shadow == NULL)
+    {
+        if (track->rtt_shadow_lost)
+            return;
+
+        entries = 1UL << (track->ipa_width - VAL_RTT_LEVEL_SHIFT(track->rtt_level_start));
+        track->rtt_shadow = val_host_mem_alloc_tag(PAGE_SIZE, entries * sizeof(void *),
+                                                   VAL_HOST_MEM_TAG_TRACK);
+        if (track->rtt_shadow == NULL)
+        {
+            track->rtt_shadow_lost = true;
+            return;
+        }
+        val_memset(track->rtt_shadow, 0, entries * sizeof(void *));
+    }
+
+    parent = val_host_rtt_shadow_table(track, ipa, level - 1);
+    if (level < VAL_RTT_MAX_LEVEL)
+        child = val_host_ipa_table_alloc();
+
+    if ((parent == NULL) || ((level < VAL_RTT_MAX_LEVEL) && (child == NULL)))
+    {
+        LOG(WARN, "RTT shadow dropped, ipa=0x%x\n", ipa);
+        track->rtt_shadow_lost = true;
+        return;
+    }
+
+    parent[val_host_rtt_shadow_entry(track, ipa, level - 1)] =
+                            (level < VAL_RTT_MAX_LEVEL) ? (void *)child : (void *)node;
+}
+
+/**
+ *   @brief    Remove a destroyed or folded RTT from the shadow of a realm
+ *   @param    realm      - Realm index in mem track
+ *   @param    ipa        - Base IPA of the RTT
+ *   @param    level      - Level of the RTT
+ *   @return   void
+**/
+static void val_host_rtt_shadow_remove(int realm, uint64_t ipa, uint64_t level)
+{
+    val_host_memory_track_ts *track = &mem_track[realm];
+    void **parent;
+    uint64_t entry;
+
+    if ((track->rtt_shadow == NULL) || (level <= track->rtt_level_start) ||
+        (level > VAL_RTT_MAX_LEVEL))
+        return;
+
+    parent = val_host_rtt_shadow_table(track, ipa, level - 1);
+    if (parent == NULL)
+        return;
+
+    entry = val_host_rtt_shadow_entry(track, ipa, level - 1);
+    if ((level < VAL_RTT_MAX_LEVEL) && (parent[entry] != NULL))
+        val_host_mem_free(parent[entry]);
+    parent[entry] = NULL;
+}
+
+/**
+ *   @brief    Find the level of the deepest RTT which covers an IPA from the
+ *             shadow of the realm, as the walk level of RTT_READ_ENTRY
+ *   @param    rd         - Realm RD
+ *   @param    ipa        - IPA
+ *   @param    level      - Deepest level to walk to
+ *   @param    walk_level - Level of the deepest RTT found
+ *   @return   Returns VAL_ERROR if the realm has no shadow
+**/
+uint32_t val_host_rtt_shadow_level(uint64_t rd, uint64_t ipa, uint64_t level,
+                                   uint64_t *walk_level)
+{
+    val_host_memory_track_ts *track;
+    val_host_rtt_entry_ts rtte;
+    void **table;
+    void *child;
+    uint64_t l;
+    int realm;
+
+    val_spin_lock(&track_lock);
+    realm = val_host_get_curr_realm(rd);
+    track = &mem_track[realm];
+    if ((realm == 0) || (track->rtt_shadow == NULL) || track->rtt_shadow_lost)
+    {
+        val_spin_unlock(&track_lock);
+        return VAL_ERROR;
+    }
+
+    table = track->rtt_shadow;
+    for (l = track->rtt_level_start; l < level; l++)
+    {
+        child = table[val_host_rtt_shadow_entry(track, ipa, l)];
+        if ((child == NULL) || (l + 1 == VAL_RTT_MAX_LEVEL))
+        {
+            l += (child != NULL);
+            break;
+        }
+        table = ((val_host_ipa_table_ts *)child)->entry;
+    }
+    val_spin_unlock(&track_lock);
+
+    *walk_level = l;
+
+    if (rtt_shadow_check)
+    {
+        if (val_host_rmi_rtt_read_entry(rd, val_host_addr_align_to_level(ipa, level), level, &rtte))
+            return VAL_ERROR;
+
+        if (rtte.walk_level != l)
+        {
+            LOG(ERROR, "RTT shadow mismatch, ipa=0x%x, level=%d\n", ipa, l);
+            *walk_level = rtte.walk_level;
+
+            val_spin_lock(&track_lock);
+            realm = val_host_get_curr_realm(rd);
+            if (realm != 0)
+                mem_track[realm].rtt_shadow_mismatch = true;
+            val_spin_unlock(&track_lock);
+        }
+    }
+
+    return VAL_SUCCESS;
+}
+
+/**
+ *   @brief    Compare every RTT shadow lookup with RTT_READ_ENTRY. The check
+ *             is turned off for every test.
+ *   @param    enable     - Enable the check
+ *   @return   void
+**/
+void val_host_rtt_shadow_check_set(bool enable)
+{
+    rtt_shadow_check = enable;
+}
+
+/**
+ *   @brief    Tell whether a checked RTT shadow lookup of a realm disagreed
+ *             with RTT_READ_ENTRY. The realm destroy fails in that case.
+ *   @param    rd         - Realm RD
+ *   @return   Returns true if a mismatch was found
+**/
+bool val_host_rtt_shadow_mismatch(uint64_t rd)
+{
+    bool mismatch;
+    int realm;
+
+    val_spin_lock(&track_lock);
+    realm = val_host_get_curr_realm(rd);
+    mismatch = (realm != 0) && mem_track[realm].rtt_shadow_mismatch;
+    val_spin_unlock(&track_lock);
+
+    return mismatch;
+}
+
+/**
+ *   @brief    Add granule to the NS mem track[0], with track_lock held
+ *   @param    state      - state of granule
+ *   @param    PA         - Physical address of granule
+ *   @param    node       - node pointer
+ *   @return   void
+**/
+static void val_host_track_add_granule(uint32_t state, uint64_t PA, val_host_granule_ts *node)
+{
+    val_host_granule_ts *granule_list;
+
+    /* Granules of the memory pool without realm metadata are only kept in
+       the granule map */
+    if (val_host_granule_map_covers(PA))
+    {
+        if ((node == NULL) && (val_host_granule_map_get(PA) != VAL_HOST_GRANULE_MAP_NODE))
+        {
+            if (state == GRANULE_DELEGATED || state == GRANULE_UNDELEGATED)
+            {
+                val_host_granule_map_set(PA, (state == GRANULE_DELEGATED) ?
+                         VAL_HOST_GRANULE_MAP_DELEGATED : VAL_HOST_GRANULE_MAP_UNDELEGATED);
+                return;
+            }
+        } else if ((node != NULL) && (node->state == GRANULE_DELEGATED) &&
+                   (node->is_granule_sliced == 0)) {
+            val_host_granule_map_set(PA, VAL_HOST_GRANULE_MAP_DELEGATED);
+            val_host_track_node_free(node);
+            return;
+        }
+    }
+
+    /* if node is null, create node and add to NS mem_track[0] list
+       else add node directly to the list */
+    if (node == NULL)
+    {
+        granule_list = val_host_track_node_alloc();
+        if (granule_list == NULL)
+            return;
+
+        granule_list->state = state;
+        granule_list->PA = PA;
+    } else
+    {
+        granule_list = node;
+    }
+
+    if (val_host_granule_index_insert(granule_list))
+    {
+        if (node == NULL)
+            val_host_track_node_free(granule_list);
+        return;
+    }
+
+    val_host_list_append(&mem_track[0].gran_type.ns, granule_list);
+
+    if (val_host_granule_map_covers(PA))
+        val_host_granule_map_set(PA, VAL_HOST_GRANULE_MAP_NODE);
+}
+
+/**
+ *   @brief    Add granule to the NS mem track[0]
+ *   @param    state      - state of granule
+ *   @param    PA         - Physical address of granule
+ *   @param    node       - node pointer
+ *   @return   void
+**/
+void val_host_add_granule(uint32_t state, uint64_t PA, val_host_granule_ts *node)
+{
+    val_spin_lock(&track_lock);
+    val_host_track_add_granule(state, PA, node);
+    val_spin_unlock(&track_lock);
+}
+
+/**
+ *   @brief    Take a granule out of the NS mem_track[0]. A node is created for
+ *             granules only recorded in the granule map.
+ *   @param    PA         - Physical address of granule
+ *   @return   Returns the granule node, or NULL if PA isn't tracked
+**/
+static val_host_granule_ts *val_host_take_ns_granule(uint64_t PA)
+{
+    val_host_granule_ts *node;
+    uint32_t map_state = VAL_HOST_GRANULE_MAP_NONE;
+
+    if (val_host_granule_map_covers(PA))
+        map_state = val_host_granule_map_get(PA);
+
+    if (map_state == VAL_HOST_GRANULE_MAP_DELEGATED || map_state == VAL_HOST_GRANULE_MAP_UNDELEGATED)
+    {
+        node = val_host_track_node_alloc();
+        if (node == NULL)
+            return NULL;
+
+        node->state = (map_state == VAL_HOST_GRANULE_MAP_DELEGATED) ?
+                                        GRANULE_DELEGATED : GRANULE_UNDELEGATED;
+        node->PA = PA;
+        val_host_granule_map_set(PA, VAL_HOST_GRANULE_MAP_NODE);
+        return node;
+    }
+
+    return val_host_remove_granule(&mem_track[0].gran_type.ns, PA);
+}
+
+static inline uint32_t val_host_realm_index_home(uint64_t rd)
+{
+    return (uint32_t)((((rd >> 12) * 0x9E3779B97F4A7C15ULL) >> 32) &
+                                                    ((2 * mem_track_slots) - 1));
+}
+
+static void val_host_realm_index_place(uint32_t realm)
+{
+    uint32_t entry = val_host_realm_index_home(mem_track[realm].rd);
+
+    while (realm_index[entry] != 0)
+        entry = (entry + 1) & ((2 * mem_track_slots) - 1);
+
+    realm_index[entry] = realm;
+}
+
+/**
+ *   @brief    Double the realm registry and rebuild its RD index
+ *   @param    void
+ *   @return   Returns VAL_SUCCESS/VAL_ERROR
+**/
+static uint32_t val_host_realm_registry_grow(void)
+{
+    val_host_memory_track_ts *slots;
+    uint32_t *index, i;
+
+    slots = val_host_mem_alloc_tag(PAGE_SIZE, 2 * mem_track_slots * sizeof(val_host_memory_track_ts),
+                                   VAL_HOST_MEM_TAG_TRACK);
+    index = val_host_mem_alloc_tag(PAGE_SIZE, 4 * mem_track_slots * sizeof(uint32_t),
+                                   VAL_HOST_MEM_TAG_TRACK);
+    if (slots == NULL || index == NULL)
+    {
+        LOG(ERROR, "Failed to grow realm registry to %d slots\n", 2 * mem_track_slots);
+        if (slots != NULL)
+            val_host_mem_free(slots);
+        if (index != NULL)
+            val_host_mem_free(index);
+        return VAL_ERROR;
+    }
+
+    val_memcpy(slots, mem_track, mem_track_top * sizeof(val_host_memory_track_ts));
+    val_memset(index, 0, 4 * mem_track_slots * sizeof(uint32_t));
+
+    if (mem_track != mem_track_static)
+    {
+        val_host_mem_free(mem_track);
+        val_host_mem_free(realm_index);
+    }
+
+    mem_track = slots;
+    realm_index = index;
+    mem_track_slots *= 2;
+
+    for (i = 1; i < mem_track_top; i++)
+    {
+        if (mem_track[i].in_use)
+            val_host_realm_index_place(i);
+    }
+
+    return VAL_SUCCESS;
+}
+
+/**
+ *   @brief    Add a realm to the registry
+ *   @param    rd      -  Realm RD granule address
+ *   @return   Returns the realm index in mem track, or 0 on failure
+**/
+static int val_host_realm_register(uint64_t rd)
+{
+    uint32_t realm;
+
+    if (mem_track_free != 0)
+    {
+        realm = mem_track_free;
+        mem_track_free = mem_track[realm].next_free;
+    } else {
+        if (mem_track_top == mem_track_slots && val_host_realm_registry_grow())
+            return 0;
+        realm = mem_track_top++;
+    }
+
+    val_memset(&mem_track[realm], 0, sizeof(val_host_memory_track_ts));
+    mem_track[realm].rd = rd;
+    mem_track[realm].in_use = true;
+    mem_track[realm].gran_type.data.ipa_indexed = true;
+    mem_track[realm].gran_type.valid_ns.ipa_indexed = true;
+    val_host_realm_index_place(realm);
+
+    return (int)realm;
+}
+
+/**
+ *   @brief    Remove a realm from the registry
+ *   @param    realm   -  Realm index in mem track
+ *   @return   void
+**/
+static void val_host_realm_unregister(int realm)
+{
+    uint32_t mask = (2 * mem_track_slots) - 1, entry, next, home;
+
+    entry = val_host_realm_index_home(mem_track[realm].rd);
+    while (realm_index[entry] != (uint32_t)realm)
+        entry = (entry + 1) & mask;
+
+    /* Shift back the entries following the hole, as for the PA index */
+    realm_index[entry] = 0;
+    next = entry;
+    while (1)
+    {
+        next = (next + 1) & mask;
+        if (realm_index[next] == 0)
+            break;
+
+        home = val_host_realm_index_home(mem_track[realm_index[next]].rd);
+        if (((next - home) & mask) >= ((next - entry) & mask))
+        {
+            realm_index[entry] = realm_index[next];
+            realm_index[next] = 0;
+            entry = next;
+        }
+    }
+
+    /* Shadows of lower level RTTs are gone with the RTTs */
+    if (mem_track[realm].rtt_shadow != NULL)
+        val_host_mem_free(mem_track[realm].rtt_shadow);
+
+    mem_track[realm].in_use = false;
+    mem_track[realm].next_free = mem_track_free;
+    mem_track_free = (uint32_t)realm;
+}
+
+/**
+ *   @brief    Get the current realm from mem track
+ *   @param    rd      -  Realm RD granule address
+ *   @return   Returns current realm index from mem track structure/0
+**/
+int val_host_get_curr_realm(uint64_t rd)
+{
+    uint32_t entry = val_host_realm_index_home(rd);
+
+    while (realm_index[entry] != 0)
+    {
+        if (mem_track[realm_index[entry]].rd == rd)
+            return (int)realm_index[entry];
+        entry = (entry + 1) & ((2 * mem_track_slots) - 1);
+    }
+
+    return 0;
+}
+
+/**
+ *   @brief    Get the registry slot of a realm while other CPUs update mem_track
+ *   @param    rd      -  Realm RD granule address
+ *   @return   Returns the slot, 0 if the realm isn't tracked
+**/
+static int val_host_realm_lookup(uint64_t rd)
+{
+    int realm;
+
+    val_spin_lock(&track_lock);
+    realm = val_host_get_curr_realm(rd);
+    val_spin_unlock(&track_lock);
+
+    return realm;
+}
+
+/**
+ *   @brief    Update the granule state in mem track, with track_lock held
+ *   @param    rd         - Realm rd
+ *   @param    state      - state of granule
+ *   @param    PA         - Physical address of granule
+ *   @param    ipa        - IPA of granule
+ *   @param    rtt_level  - RTT level
+ *   @return   void
+**/
+static void val_host_track_update_granule_state(uint64_t rd, uint32_t state, uint64_t PA,
+                                   uint64_t ipa, uint64_t rtt_level, uint64_t rtt_tree_idx)
+{
+    val_host_granule_ts *granule_node = NULL;
+
+    /* Get the current realm index for given realm rd */
+    current_realm = val_host_get_curr_realm(rd);
+
+    /* take node from NS mem_track[0] */
+    granule_node = val_host_take_ns_granule(PA);
+
+    /* if node is not found add to the VALID_NS list */
+    if (granule_node == NULL)
+    {
+        val_host_granule_ts *granule_list_delegated;
+
+        if (state != GRANULE_UNPROTECTED)
+            return;
+
+        granule_list_delegated = val_host_track_node_alloc();
+        if (granule_list_delegated == NULL)
+            return;
+
+        granule_list_delegated->rd = rd;
+        granule_list_delegated->state = state;
+        granule_list_delegated->PA = PA;
+        granule_list_delegated->ipa = ipa;
+        granule_list_delegated->level = rtt_level;
+        granule_list_delegated->rtt_tree_idx = rtt_tree_idx;
+
+        val_host_list_append(&mem_track[current_realm].gran_type.valid_ns, granule_list_delegated);
+        return;
+    }
+
+    /* Update state from NS mem_track or remove node and add to the respective state list */
+    switch (state)
+    {
+        case GRANULE_RD:
+            val_host_mem_set_tag(PA, VAL_HOST_MEM_TAG_RD);
+            granule_node->rd = rd;
+            granule_node->state = state;
+            granule_node->ipa = ipa;
+            granule_node->level = rtt_level;
+
+            /* Add realm rd to the mem_track */
+            if (val_host_get_curr_realm(PA) != 0)
+            {
+                LOG(ERROR, "Realm already exists\n");
+            } else {
+                current_realm = val_host_realm_register(PA);
+            }
+
+            val_host_list_append(&mem_track[current_realm].gran_type.rd, granule_node);
+            break;
+
+        case GRANULE_REC:
+            val_host_mem_set_tag(PA, VAL_HOST_MEM_TAG_REC);
+            granule_node->rd = rd;
+            granule_node->state = state;
+            granule_node->ipa = ipa;
+            granule_node->level = rtt_level;
+
+            val_host_list_append(&mem_track[current_realm].gran_type.rec, granule_node);
+
+            break;
+
+        case GRANULE_RTT:
+            val_host_mem_set_tag(PA, VAL_HOST_MEM_TAG_RTT);
+            granule_node->rd = rd;
+            granule_node->state = state;
+            granule_node->ipa = ipa;
+            granule_node->level = rtt_level;
+
+            val_host_list_append(&mem_track[current_realm].gran_type.rtt, granule_node);
+            val_host_rtt_shadow_add(current_realm, ipa, rtt_level, granule_node);
+
+            break;
+
+        case GRANULE_RTT_AUX:
+            val_host_mem_set_tag(PA, VAL_HOST_MEM_TAG_RTT_AUX);
+            granule_node->rd = rd;
+            granule_node->state = state;
+            granule_node->ipa = ipa;
+            granule_node->level = rtt_level;
+            granule_node->rtt_tree_idx = rtt_tree_idx;
+
+            val_host_list_append(&mem_track[current_realm].gran_type.rtt_aux, granule_node);
+
+            break;
+
+        case GRANULE_DATA:
+            val_host_mem_set_tag(PA, VAL_HOST_MEM_TAG_DATA);
+            granule_node->rd = rd;
+            granule_node->state = state;
+            granule_node->ipa = ipa;
+            granule_node->level = rtt_level;
+
+            val_host_list_append(&mem_track[current_realm].gran_type.data, granule_node);
+
+            break;
+
+        case GRANULE_UNPROTECTED:
+            granule_node->rd = rd;
+            granule_node->ipa = ipa;
+            granule_node->level = rtt_level;
+
+            val_host_list_append(&mem_track[current_realm].gran_type.valid_ns, granule_node);
+
+            break;
+
+        default:
+            val_host_track_add_granule(granule_node->state, PA, granule_node);
+            break;
+    }
+}
+
+/**
+ *   @brief    Update the granule state in mem track
+ *   @param    rd         - Realm rd
+ *   @param    state      - state of granule
+ *   @param    PA         - Physical address of granule
+ *   @param    ipa        - IPA of granule
+ *   @param    rtt_level  - RTT level
+ *   @return   void
+**/
+void val_host_update_granule_state(uint64_t rd, uint32_t state, uint64_t PA,
+                                   uint64_t ipa, uint64_t rtt_level, uint64_t rtt_tree_idx)
+{
+    val_spin_lock(&track_lock);
+    val_host_track_update_granule_state(rd, state, PA, ipa, rtt_level, rtt_tree_idx);
+    val_spin_unlock(&track_lock);
+}
+
+/**
+ *   @brief    Return the granule from NS mem track
+ *   @param    PA         - Physical address of granule
+ *   @return   Returns the granule for given PA from NS mem track, NULL if the
+ *             granule has no node and is only recorded in the granule map
+**/
+val_host_granule_ts *val_host_find_granule(uint64_t PA)
+{
+    uint64_t slot = val_host_granule_index_lookup(PA);
+
+    if (slot == granule_index_slots)
+        return NULL;
+
+    return granule_index[slot];
+}
+
+/**
+ *   @brief    Remove granule from given mem track list
+ *   @param    gran_list           - granule list
+ *   @param    PA                  - Physical address of granule
+ *   @return   Returns the removed granule from mem track list
+**/
+val_host_granule_ts *val_host_remove_granule(val_host_granule_list_ts *gran_list, uint64_t PA)
+{
+    val_host_granule_ts *current;
+    uint64_t slot;
+
+    /* Nodes of the NS mem_track list are found through the PA index */
+    if (gran_list == &mem_track[0].gran_type.ns)
+    {
+        slot = val_host_granule_index_lookup(PA);
+        if (slot == granule_index_slots)
+            return NULL;
+
+        current = granule_index[slot];
+        val_host_granule_index_remove(slot);
+    } else {
+        /* Unprotected mappings are tracked with the IPA as PA */
+        current = val_host_find_ipa_granule(gran_list, PA);
+        if ((current == NULL) || (current->PA != PA))
+        {
+            current = gran_list->head;
+            while ((current != NULL) && (current->PA != PA))
+                current = current->next;
+        }
+
+        if (current == NULL)
+            return NULL;
+    }
+
+    val_host_list_unlink(gran_list, current);
+    return current;
+}
+
+/**
+ *   @brief    Find the granule mapped at an IPA in a DATA or unprotected list
+ *   @param    gran_list           - granule list
+ *   @param    ipa                 - IPA of the granule
+ *   @return   Returns the granule, or NULL if the IPA isn't in the list
+**/
+val_host_granule_ts *val_host_find_ipa_granule(val_host_granule_list_ts *gran_list, uint64_t ipa)
+{
+    val_host_granule_ts *current;
+    void **leaf;
+
+    if (gran_list->ipa_indexed)
+    {
+        leaf = val_host_ipa_index_leaf(gran_list, ipa);
+        return (leaf != NULL) ? *leaf : NULL;
+    }
+
+    for (current = gran_list->head; current != NULL; current = current->next)
+    {
+        if (current->ipa == ipa)
+            return current;
+    }
+
+    return NULL;
+}
+
+/**
+ *   @brief    Find the granule with the lowest IPA not below ipa in a DATA or
+ *             unprotected list. Iterating with the IPA following the returned
+ *             granule visits the list in IPA order.
+ *   @param    gran_list           - granule list
+ *   @param    ipa                 - Lowest IPA
+ *   @return   Returns the granule, or NULL if there is none
+**/
+val_host_granule_ts *val_host_next_ipa_granule(val_host_granule_list_ts *gran_list, uint64_t ipa)
+{
+    val_host_granule_ts *current, *next = NULL;
+
+    if (gran_list->ipa_indexed)
+    {
+        if (gran_list->ipa_root == NULL)
+            return NULL;
+
+        return val_host_ipa_index_next(gran_list->ipa_root, 0, ipa);
+    }
+
+    for (current = gran_list->head; current != NULL; current = current->next)
+    {
+        if ((current->ipa >= ipa) && ((next == NULL) || (current->ipa < next->ipa)))
+            next = current;
+    }
+
+    return next;
+}
+
+/**
+ *   @brief    Find the granule with the lowest IPA in [ipa, top) of a DATA or
+ *             unprotected list while other CPUs update the list. Granules
+ *             above top may be released concurrently, so they are not returned.
+ *   @param    gran_list           - granule list
+ *   @param    ipa                 - Lowest IPA
+ *   @param    top                 - Top IPA, exclusive
+ *   @return   Returns the granule, or NULL if there is none
+**/
+static val_host_granule_ts *val_host_next_ipa_granule_below(val_host_granule_list_ts *gran_list,
+                                                            uint64_t ipa, uint64_t top)
+{
+    val_host_granule_ts *next;
+
+    val_spin_lock(&track_lock);
+    next = val_host_next_ipa_granule(gran_list, ipa);
+    if ((next != NULL) && (next->ipa >= top))
+        next = NULL;
+    val_spin_unlock(&track_lock);
+
+    return next;
+}
+
+/**
+ *   @brief    Rollback mem_track state update, with track_lock held
+ *   @param    rd                - Realm RD
+ *   @param    PA                - Physical address of granule
+ *   @param    ipa               - IPA Address
+ *   @param    level             - RTT level
+ *   @param    state             - state of granule
+ *   @param    gran_list_state   - granule list state
+ *   @return   void
+**/
+static void val_host_track_update_destroy_granule_state(uint64_t rd, uint64_t PA,
+                                       uint64_t ipa, uint64_t level,
+                           uint32_t state, uint32_t gran_list_state, uint64_t rtt_tree_idx)
+{
+    val_host_granule_ts *node = NULL;
+    int i;
+
+    if (state == GRANULE_UNDELEGATED)
+    {
+        if (val_host_granule_map_covers(PA) &&
+            val_host_granule_map_get(PA) != VAL_HOST_GRANULE_MAP_NODE)
+        {
+            if (val_host_granule_map_get(PA) != VAL_HOST_GRANULE_MAP_NONE)
+                val_host_granule_map_set(PA, VAL_HOST_GRANULE_MAP_NONE);
+            return;
+        }
+
+        node = val_host_find_granule(PA);
+        if (node != NULL)
+        {
+            if (node->is_granule_sliced == 0)
+            {
+                node = val_host_remove_granule(&mem_track[0].gran_type.ns, PA);
+                if (val_host_granule_map_covers(PA))
+                    val_host_granule_map_set(PA, VAL_HOST_GRANULE_MAP_NONE);
+                val_host_track_node_free(node);
+                return;
+            } else if (node->is_granule_sliced == 1) {
+                     node->state = state;
+            }
+        }
+        return;
+    }
+
+    if (gran_list_state != GRANULE_REC)
+    {
+        current_realm = val_host_get_curr_realm(rd);
+    }
+
+    switch (gran_list_state)
+    {
+        case GRANULE_RTT:
+            node = val_host_remove_rtt_granule(&mem_track[current_realm].gran_type.rtt, ipa, level);
+            val_host_rtt_shadow_remove(current_realm, ipa, level);
+            node->state = state;
+            val_host_track_add_granule(state, node->PA, node);
+            break;
+
+        case GRANULE_RTT_AUX:
+            node = val_host_remove_aux_rtt_granule(&mem_track[current_realm].gran_type.rtt_aux,
+                                                                         ipa, level, rtt_tree_idx);
+            node->state = state;
+            val_host_track_add_granule(state, node->PA, node);
+            break;
+
+        case GRANULE_DATA:
+            node = val_host_remove_data_granule(&mem_track[current_realm].gran_type.data, ipa);
+            node->state = state;
+            val_host_track_add_granule(state, node->PA, node);
+            break;
+
+        case GRANULE_REC:
+            for (i = 1; i < (int)mem_track_top; i++)
+            {
+                if (!mem_track[i].in_use)
+                    continue;
+
+                node = val_host_remove_granule(&mem_track[i].gran_type.rec, PA);
+                if (node != NULL)
+                {
+                    node->state = state;
+                    val_host_track_add_granule(state, PA, node);
+                    break;
+                }
+            }
+            break;
+
+        case GRANULE_RD:
+            node = val_host_remove_granule(&mem_track[current_realm].gran_type.rd, PA);
+            node->state = state;
+            val_host_track_add_granule(state, PA, node);
+            val_host_realm_unregister(current_realm);
+            break;
+
+        case GRANULE_UNPROTECTED:
+            node = val_host_remove_granule(&mem_track[current_realm].gran_type.valid_ns, PA);
+            node->state = GRANULE_UNDELEGATED;
+            val_host_track_add_granule(state, PA, node);
+            break;
+    }
+}
+
+/**
+ *   @brief    Rollback mem_track state update
+ *   @param    rd                - Realm RD
+ *   @param    PA                - Physical address of granule
+ *   @param    ipa               - IPA Address
+ *   @param    level             - RTT level
+ *   @param    state             - state of granule
+ *   @param    gran_list_state   - granule list state
+ *   @return   void
+**/
+void val_host_update_destroy_granule_state(uint64_t rd, uint64_t PA,
+                                       uint64_t ipa, uint64_t level,
+                           uint32_t state, uint32_t gran_list_state, uint64_t rtt_tree_idx)
+{
+    val_spin_lock(&track_lock);
+    val_host_track_update_destroy_granule_state(rd, PA, ipa, level, state, gran_list_state,
+                                                                            rtt_tree_idx);
+    val_spin_unlock(&track_lock);
+}
+
+/**
+ *   @brief    Record the level of the entries mapping the DATA granules of an
+ *             IPA range, after RTT_FOLD turned them into a block or RTT_CREATE
+ *             split a block. Level 0 or VAL_RTT_MAX_LEVEL is a page entry.
+ *   @param    rd                - Realm RD
+ *   @param    base              - Base of the IPA range
+ *   @param    top               - Top of the IPA range, exclusive
+ *   @param    level             - Level of the entries
+ *   @return   void
+**/
+void val_host_update_data_map_level(uint64_t rd, uint64_t base, uint64_t top, uint64_t level)
+{
+    val_host_granule_list_ts *data;
+    val_host_granule_ts *gran;
+    uint64_t ipa = base;
+    int realm;
+
+    val_spin_lock(&track_lock);
+    realm = val_host_get_curr_realm(rd);
+    if (realm != 0)
+    {
+        data = &mem_track[realm].gran_type.data;
+        while ((gran = val_host_next_ipa_granule(data, ipa)) != NULL && gran->ipa < top)
+        {
+            gran->level = level;
+            ipa = gran->ipa + PAGE_SIZE;
+        }
+    }
+    val_spin_unlock(&track_lock);
+}
+
+/**
+ *   @brief    Remove data granule from data list and add to the NS mem_track
+ *   @param    gran_list           - Data granule which needs to remove from data list
+ *                                   and add to NS mem track
+ *   @param    ipa                 - IPA which needs to remove from data list
+ *   @return   Returns the node from data list
+**/
+val_host_granule_ts *val_host_remove_data_granule(val_host_granule_list_ts *gran_list,
+                                                                          uint64_t ipa)
+{
+    val_host_granule_ts *current = val_host_find_ipa_granule(gran_list, ipa);
+
+    if (current != NULL)
+        val_host_list_unlink(gran_list, current);
+
+    return current;
+}
+
+/**
+ *   @brief    Remove RTT granule from RTT list and add to the NS mem_track
+ *   @param    gran_list           - RTT granule list
+ *   @param    ipa                 - IPA of the RTT
+ *   @param    level               - Level of the RTT
+ *   @return   Returns the node from RTT list
+**/
+val_host_granule_ts *val_host_remove_rtt_granule(val_host_granule_list_ts *gran_list,
+                                                         uint64_t ipa, uint64_t level)
+{
+    val_host_granule_ts *current = gran_list->head;
+
+    while ((current != NULL) && ((current->level != level) || (current->ipa != ipa)))
+        current = current->next;
+
+    if (current != NULL)
+        val_host_list_unlink(gran_list, current);
+
+    return current;
+}
+
+/**
+ *   @brief    Remove auxiliary RTT granule from auxiliary RTT list and add to the NS mem_track
+ *   @param    gran_list           - Auxiliary RTT granule list
+ *   @param    ipa                 - IPA of the RTT
+ *   @param    level               - Level of the RTT
+ *   @param    index               - RTT tree index
+ *   @return   Returns the node from auxiliary RTT list
+**/
+val_host_granule_ts *val_host_remove_aux_rtt_granule(val_host_granule_list_ts *gran_list,
+                                                uint64_t ipa, uint64_t level, uint64_t index)
+{
+    val_host_granule_ts *current = gran_list->head;
+
+    while ((current != NULL) && ((current->level != level) || (current->ipa != ipa) ||
+                                 (current->rtt_tree_idx != index)))
+        current = current->next;
+
+    if (current != NULL)
+        val_host_list_unlink(gran_list, current);
+
+    return current;
+}
+
+/**
+ *   @brief    Destroy rtt levels
+ *   @param    rtt_level      - RTT level to destroy
+ *   @param    current_realm  - current realm index in mem track
+ *   @return   SUCCESS/FAILURE
+**/
+uint64_t val_host_destroy_rtt_levels(uint64_t rtt_level, int current_realm)
+{
+    val_host_granule_ts *curr_gran = NULL, *next_gran = NULL;
+    uint64_t ret, PA;
+    val_host_rtt_destroy_ts rtt_destroy;
+
+    curr_gran = mem_track[current_realm].gran_type.rtt.head;
+    while (curr_gran != NULL)
+    {
+        next_gran = curr_gran->next;
+        if (curr_gran->level == rtt_level)
+        {
+            PA = curr_gran->PA;
+            ret = val_host_rmi_rtt_destroy(curr_gran->rd,
+                                           curr_gran->ipa, curr_gran->level, &rtt_destroy);
+            if (ret)
+            {
+                LOG(ERROR, "realm_rtt_destroy failed, rtt=0x%x, ret=0x%x\n", curr_gran->ipa, ret);
+                return VAL_ERROR;
+            }
+            if (val_host_granule_pool_put(PA))
+                return VAL_ERROR;
+
+            curr_gran = next_gran;
+        } else {
+            curr_gran = next_gran;
+        }
+    }
+    return VAL_SUCCESS;
+}
 
 /**
- *   @brief    Get the current realm from mem track
- *   @param    rd      -  Realm RD granule address
- *   @return   Returns current realm index from mem track structure/0
+ *   @brief    Destroy auxiliary rtt levels
+ *   @param    rtt_level      - RTT level to destroy
+ *   @param    current_realm  - current realm index in mem track
+ *   @return   SUCCESS/FAILURE
 **/
-int val_host_get_curr_realm(uint64_t rd)
+uint64_t val_host_destroy_aux_rtt_levels(uint64_t rtt_level, int current_realm, uint64_t index)
 {
-    int i;
+    val_host_granule_ts *curr_gran = NULL, *next_gran = NULL;
+    val_smc_param_ts cmd_ret;
+    uint64_t PA;
 
-    for (i = 1; i < VAL_HOST_MAX_REALMS; i++)
+    curr_gran = mem_track[current_realm].gran_type.rtt_aux.head;
+    while (curr_gran != NULL)
     {
-        if (mem_track[i].rd == rd)
+        next_gran = curr_gran->next;
+        if ((curr_gran->level == rtt_level) && (curr_gran->rtt_tree_idx == index))
         {
-            return i;
+            PA = curr_gran->PA;
+            cmd_ret = val_host_rmi_rtt_aux_destroy(curr_gran->rd,
+                                           curr_gran->ipa, curr_gran->level, index);
+            if (cmd_ret.x0)
+            {
+                LOG(ERROR, "realm_rtt_destroy failed, rtt=0x%x, ret=0x%x\n", curr_gran->ipa,
+                                                                                 cmd_ret.x0);
+                return VAL_ERROR;
+            }
+
+            if (val_host_granule_pool_put(PA))
+                return VAL_ERROR;
+
+            curr_gran = next_gran;
+        } else {
+            curr_gran = next_gran;
         }
     }
-    return 0;
+    return VAL_SUCCESS;
 }
 
 /**
- *   @brief    Update the granule state in mem track
- *   @param    rd         - Realm rd
- *   @param    state      - state of granule
- *   @param    PA         - Physical address of granule
- *   @param    ipa        - IPA of granule
- *   @param    rtt_level  - RTT level
+ *   @brief    Set how val_host_postamble destroys the realms left by a test.
+ *             The mode is reset to VAL_HOST_POSTAMBLE_SERIAL for every test.
+ *   @param    mode    -  Postamble mode
  *   @return   void
 **/
-void val_host_update_granule_state(uint64_t rd, uint32_t state, uint64_t PA,
-                                   uint64_t ipa, uint64_t rtt_level, uint64_t rtt_tree_idx)
+void val_host_postamble_mode_set(val_host_postamble_mode_te mode)
 {
-    val_host_granule_ts *granule_node = NULL;
-    int i;
+#ifdef SECURE_TEST_ENABLE
+    /* Secondary cpus aren't available to the host with the secure payload */
+    if (mode == VAL_HOST_POSTAMBLE_PARALLEL)
+    {
+        LOG(WARN, "Parallel postamble not supported, using serial\n");
+        return;
+    }
+#endif
+    postamble_mode = mode;
+}
 
-    /* Get the current realm index for given realm rd */
-    current_realm = val_host_get_curr_realm(rd);
+/**
+ *   @brief    Set how val_host_map_protected_data_to_realm populates large
+ *             protected ranges. The mode is reset to VAL_HOST_POPULATE_SERIAL
+ *             for every test.
+ *   @param    mode    -  Population mode
+ *   @return   void
+**/
+void val_host_populate_mode_set(val_host_populate_mode_te mode)
+{
+#ifdef SECURE_TEST_ENABLE
+    /* Secondary cpus aren't available to the host with the secure payload */
+    if (mode == VAL_HOST_POPULATE_PARALLEL)
+    {
+        LOG(WARN, "Parallel population not supported, using serial\n");
+        return;
+    }
+#endif
+    populate_mode = mode;
+}
 
-    /* find node from NS mem_track[0] */
-    granule_node = val_host_find_granule(PA);
+/**
+ *   @brief    Get how val_host_map_protected_data_to_realm populates large
+ *             protected ranges
+ *   @param    void
+ *   @return   Population mode
+**/
+val_host_populate_mode_te val_host_populate_mode_get(void)
+{
+    return populate_mode;
+}
 
-    /* if node is not found add to the VALID_NS list */
-    if (granule_node == NULL)
+/**
+ *   @brief    Append an item to the work shared with the secondary cpus
+ *   @param    count          -  Number of items, updated
+ *   @param    op             -  Operation of the item
+ *   @param    rd             -  Realm RD granule address
+ *   @param    base           -  Base of the IPA range
+ *   @param    top            -  Top of the IPA range, exclusive
+ *   @return   Returns the new item
+**/
+static val_host_mp_work_ts *val_host_mp_work_add(uint32_t *count, val_host_mp_work_op_te op,
+                                                 uint64_t rd, uint64_t base, uint64_t top)
+{
+    val_host_mp_work_ts *work = &mp_work[(*count)++];
+
+    val_memset(work, 0, sizeof(val_host_mp_work_ts));
+    work->op = op;
+    work->rd = rd;
+    work->base = base;
+    work->top = top;
+
+    return work;
+}
+
+/**
+ *   @brief    Run work items of the current phase until there are none left
+ *             or one of them failed
+ *   @param    void
+ *   @return   void
+**/
+static void val_host_mp_work_run(void)
+{
+    val_host_mp_work_ts *work;
+    uint32_t ret;
+
+    while (1)
     {
-        val_host_granule_ts *granule_list_delegated =
-                             (val_host_granule_ts *) mem_alloc(sizeof(val_host_granule_ts),
-                                                                    sizeof(val_host_granule_ts));
-        granule_list_delegated->rd = rd;
-        granule_list_delegated->state = state;
-        granule_list_delegated->PA = PA;
-        granule_list_delegated->ipa = ipa;
-        granule_list_delegated->level = rtt_level;
-        granule_list_delegated->rtt_tree_idx = rtt_tree_idx;
-        granule_list_delegated->next = NULL;
-        for (i = 0; i < VAL_MAX_AUX_PLANES; i++)
-            granule_list_delegated->has_auxiliary[i] = 0;
+        val_spin_lock(&mp_lock);
+        if ((mp_work_next == mp_work_end) || (mp_status != VAL_SUCCESS))
+        {
+            val_spin_unlock(&mp_lock);
+            return;
+        }
+        work = &mp_work[mp_work_next++];
+        val_spin_unlock(&mp_lock);
 
-        if (state == GRANULE_UNPROTECTED)
+        switch (work->op)
         {
-            current = mem_track[current_realm].gran_type.valid_ns;
-            if (current == NULL)
-            {
-                 mem_track[current_realm].gran_type.valid_ns = granule_list_delegated;
-            } else
-            {
-                while (current->next != NULL)
-                {
-                    current = current->next;
-                }
-                current->next = granule_list_delegated;
-            }
+            case VAL_HOST_MP_WORK_DESTROY_REALM:
+                ret = val_host_realm_destroy(work->rd);
+                break;
+            case VAL_HOST_MP_WORK_MAP_RANGE:
+                ret = val_host_map_protected_data_range(work->realm, work->target_pa,
+                                                        work->base, work->top, work->src_pa,
+                                                        work->rtt_alignment);
+                break;
+            default:
+                ret = val_host_realm_unmap_range(work->rd, work->base, work->top);
+                break;
+        }
+
+        if (ret)
+        {
+            LOG(ERROR, "Parallel work failed, rd=0x%x, ipa=0x%x\n", work->rd, work->base);
+            val_spin_lock(&mp_lock);
+            mp_status = VAL_ERROR;
+            val_spin_unlock(&mp_lock);
+            return;
         }
-        return;
     }
+}
 
-    /* Update state from NS mem_track or remove node and add to the respective state list */
-    current = head;
+/**
+ *   @brief    Check whether a secondary cpu was woken up to share the work of
+ *             a parallel postamble or population
+ *   @param    void
+ *   @return   Returns true if the cpu must run val_host_mp_worker
+**/
+bool val_host_mp_worker_pending(void)
+{
+    return mp_active;
+}
 
-    switch (state)
+/**
+ *   @brief    Work loop of a secondary cpu during a parallel postamble or
+ *             population. It runs the work of each phase it is sent and
+ *             powers the cpu off at the end.
+ *   @param    void
+ *   @return   void (Never returns)
+**/
+void val_host_mp_worker(void)
+{
+    uint32_t cpuid = val_get_cpuid(val_read_mpidr() & PAL_MPIDR_AFFINITY_MASK);
+
+    while (1)
     {
-        case GRANULE_RD:
-            val_host_remove_granule(&mem_track[0].gran_type.ns, PA);
-            granule_node->rd = rd;
-            granule_node->state = state;
-            granule_node->ipa = ipa;
-            granule_node->level = rtt_level;
-            granule_node->next = NULL;
+        val_wait_for_event(&mp_go[cpuid]);
+        if (!mp_active)
+            break;
 
-            /* Add realm rd to the mem_track */
-            for (i = 1; i < VAL_HOST_MAX_REALMS; i++)
-            {
-                if (mem_track[i].rd == PA)
-                {
-                    LOG(ERROR, "Realm already exists\n");
-                    break;
-                } else if (mem_track[i].rd == 0x00000000FFFFFFFF) {
-                    current_realm = i;
-                    mem_track[current_realm].rd = PA;
-                    break;
-                }
-            }
+        val_host_mp_work_run();
+        val_send_event(&mp_done);
+    }
 
-            mem_track[current_realm].gran_type.rd = granule_node;
-            break;
+    val_send_event(&mp_done);
+    val_host_power_off_cpu();
+}
 
-        case GRANULE_REC:
-            val_host_remove_granule(&mem_track[0].gran_type.ns, PA);
-            granule_node->rd = rd;
-            granule_node->state = state;
-            granule_node->ipa = ipa;
-            granule_node->level = rtt_level;
-            granule_node->next = NULL;
-            current = mem_track[current_realm].gran_type.rec;
+/**
+ *   @brief    Power on the secondary cpus to share the work in mp_work
+ *   @param    cpu_on    -  Secondary cpus running the worker, updated
+ *   @return   Returns the number of secondary cpus running the worker
+**/
+static uint32_t val_host_mp_start(bool *cpu_on)
+{
+    uint64_t primary_mpidr = val_read_mpidr() & PAL_MPIDR_AFFINITY_MASK;
+    uint32_t cpu_count = val_get_cpu_count();
+    uint32_t i, workers = 0;
+
+    val_init_spinlock(&mp_lock);
+    val_init_event(&mp_done);
+    mp_status = VAL_SUCCESS;
+    mp_work_next = 0;
+    mp_work_end = 0;
+    mp_active = true;
+
+    for (i = 0; i < cpu_count && i < PLATFORM_CPU_COUNT; i++)
+    {
+        if (val_get_mpidr(i) == primary_mpidr)
+            continue;
 
-            if (current == NULL)
-            {
-                 mem_track[current_realm].gran_type.rec = granule_node;
-            } else {
-                while (current->next != NULL)
-                {
-                    current = current->next;
-                }
-                current->next = granule_node;
-            }
+        val_init_event(&mp_go[i]);
+        if (val_host_power_on_cpu(i) == VAL_SUCCESS)
+        {
+            cpu_on[i] = true;
+            workers++;
+        }
+    }
 
-            break;
+    return workers;
+}
 
-        case GRANULE_RTT:
-            val_host_remove_granule(&mem_track[0].gran_type.ns, PA);
-            granule_node->rd = rd;
-            granule_node->state = state;
-            granule_node->ipa = ipa;
-            granule_node->level = rtt_level;
-            granule_node->next = NULL;
+/**
+ *   @brief    Run a phase of the shared work on all cpus and wait for the
+ *             secondary cpus to finish it
+ *   @param    first     -  First work item of the phase
+ *   @param    end       -  End of the work items of the phase
+ *   @param    cpu_on    -  Secondary cpus running the worker
+ *   @param    workers   -  Number of secondary cpus running the worker
+ *   @return   SUCCESS/FAILURE
+**/
+static uint32_t val_host_mp_phase(uint32_t first, uint32_t end, bool *cpu_on,
+                                  uint32_t workers)
+{
+    uint32_t cpu_count = val_get_cpu_count();
+    uint32_t i;
 
-            current = mem_track[current_realm].gran_type.rtt;
-            if (current == NULL)
-            {
-                 mem_track[current_realm].gran_type.rtt = granule_node;
-            } else {
-                while (current->next != NULL)
-                {
-                    current = current->next;
-                }
-                current->next = granule_node;
-            }
+    mp_work_next = first;
+    mp_work_end = end;
 
-            break;
+    for (i = 0; i < cpu_count && i < PLATFORM_CPU_COUNT; i++)
+    {
+        if (cpu_on[i])
+            val_send_event(&mp_go[i]);
+    }
 
-        case GRANULE_RTT_AUX:
-            val_host_remove_granule(&mem_track[0].gran_type.ns, PA);
-            granule_node->rd = rd;
-            granule_node->state = state;
-            granule_node->ipa = ipa;
-            granule_node->level = rtt_level;
-            granule_node->rtt_tree_idx = rtt_tree_idx;
-            granule_node->next = NULL;
+    val_host_mp_work_run();
 
-            current = mem_track[current_realm].gran_type.rtt_aux;
-            if (current == NULL)
-            {
-                 mem_track[current_realm].gran_type.rtt_aux = granule_node;
-            } else {
-                while (current->next != NULL)
-                {
-                    current = current->next;
-                }
-                current->next = granule_node;
-            }
+    /* Join the secondary cpus before the next phase */
+    for (i = 0; i < workers; i++)
+        val_wait_for_event(&mp_done);
 
-            break;
+    return mp_status;
+}
 
-        case GRANULE_DATA:
-            val_host_remove_granule(&mem_track[0].gran_type.ns, PA);
-            granule_node->rd = rd;
-            granule_node->state = state;
-            granule_node->ipa = ipa;
-            granule_node->level = rtt_level;
-            granule_node->next = NULL;
+/**
+ *   @brief    Release the secondary cpus and wait for them to be off
+ *   @param    cpu_on    -  Secondary cpus running the worker
+ *   @param    workers   -  Number of secondary cpus running the worker
+ *   @return   void
+**/
+static void val_host_mp_stop(bool *cpu_on, uint32_t workers)
+{
+    uint32_t cpu_count = val_get_cpu_count();
+    uint32_t i;
 
-            current = mem_track[current_realm].gran_type.data;
-            if (current == NULL)
-            {
-                 mem_track[current_realm].gran_type.data = granule_node;
-            } else {
-                while (current->next != NULL)
-                {
-                    current = current->next;
-                }
-                current->next = granule_node;
-            }
+    mp_active = false;
+    for (i = 0; i < cpu_count && i < PLATFORM_CPU_COUNT; i++)
+    {
+        if (cpu_on[i])
+            val_send_event(&mp_go[i]);
+    }
 
-            break;
+    for (i = 0; i < workers; i++)
+        val_wait_for_event(&mp_done);
 
-        case GRANULE_UNPROTECTED:
-            val_host_remove_granule(&mem_track[0].gran_type.ns, PA);
-            granule_node->rd = rd;
-            granule_node->ipa = ipa;
-            granule_node->level = rtt_level;
-            granule_node->next = NULL;
+    for (i = 0; i < cpu_count && i < PLATFORM_CPU_COUNT; i++)
+    {
+        if (!cpu_on[i])
+            continue;
+
+        while (val_psci_affinity_info(val_get_mpidr(i), 0) != PSCI_E_OFF)
+            ;
+    }
+
+    val_host_mem_free(mp_work);
+    mp_work = NULL;
+}
+
+/**
+ *   @brief    Destroy the realms left by a test using all the cpus. The DATA
+ *             of large realms is first destroyed in IPA ranges, one per cpu,
+ *             then each realm is destroyed as a whole by one cpu.
+ *   @param    void
+ *   @return   SUCCESS/FAILURE
+**/
+static uint32_t val_host_postamble_parallel(void)
+{
+    val_host_granule_list_ts *data;
+    val_host_granule_ts *gran;
+    bool cpu_on[PLATFORM_CPU_COUNT] = {false};
+    uint64_t ipa, base, per_range, granules;
+    uint32_t cpu_count = val_get_cpu_count();
+    uint32_t realms = 0, count = 0, split_end, workers, ret;
+    uint32_t i;
+
+    for (i = 1; i < mem_track_top; i++)
+    {
+        if (mem_track[i].in_use)
+            realms++;
+    }
+
+    if (realms == 0)
+        return VAL_SUCCESS;
+
+    /* A split realm takes up to cpu_count + 1 ranges and its own item */
+    mp_work = val_host_mem_alloc_tag(sizeof(uint64_t), (uint64_t)realms * (cpu_count + 2) *
+                                     sizeof(val_host_mp_work_ts), VAL_HOST_MEM_TAG_TRACK);
+    if (mp_work == NULL)
+    {
+        LOG(ERROR, "Failed to allocate teardown work\n");
+        return VAL_ERROR;
+    }
+
+    /* DATA of large realms, in IPA ranges holding about as many granules */
+    for (i = 1; i < mem_track_top; i++)
+    {
+        data = &mem_track[i].gran_type.data;
+        if (!mem_track[i].in_use || (data->count < VAL_HOST_POSTAMBLE_SPLIT_MIN))
+            continue;
+
+        /* Concurrent lookups need the IPA index */
+        if (!data->ipa_indexed || !mem_track[i].gran_type.valid_ns.ipa_indexed)
+            continue;
+
+        per_range = (data->count + cpu_count - 1) / cpu_count;
+        base = 0;
+        ipa = 0;
+        granules = 0;
+        while ((gran = val_host_next_ipa_granule(data, ipa)) != NULL)
+        {
+            ipa = gran->ipa + PAGE_SIZE;
 
-            current = mem_track[current_realm].gran_type.valid_ns;
-            if (current == NULL)
+            /* A block is split by one cpu, so it is kept in one range */
+            if (gran->level != 0 && gran->level < VAL_RTT_MAX_LEVEL)
             {
-                 mem_track[current_realm].gran_type.valid_ns = granule_node;
-            } else {
-                while (current->next != NULL)
-                {
-                    current = current->next;
-                }
-                current->next = granule_node;
+                ipa = ADDR_ALIGN_DOWN(gran->ipa, val_host_rtt_level_mapsize(gran->level)) +
+                                            val_host_rtt_level_mapsize(gran->level);
+                granules += val_host_rtt_level_mapsize(gran->level) / PAGE_SIZE - 1;
             }
 
-            break;
+            if (++granules >= per_range)
+            {
+                val_host_mp_work_add(&count, VAL_HOST_MP_WORK_UNMAP_RANGE, mem_track[i].rd,
+                                     base, ipa);
+                base = ipa;
+                granules = 0;
+            }
+        }
+        val_host_mp_work_add(&count, VAL_HOST_MP_WORK_UNMAP_RANGE, mem_track[i].rd,
+                             base, UINT64_MAX);
+    }
+    split_end = count;
 
-        default:
-            break;
+    /* Then the realms themselves */
+    for (i = 1; i < mem_track_top; i++)
+    {
+        if (mem_track[i].in_use)
+            val_host_mp_work_add(&count, VAL_HOST_MP_WORK_DESTROY_REALM, mem_track[i].rd, 0, 0);
     }
+
+    workers = val_host_mp_start(cpu_on);
+
+    ret = val_host_mp_phase(0, split_end, cpu_on, workers);
+    if (ret == VAL_SUCCESS)
+        ret = val_host_mp_phase(split_end, count, cpu_on, workers);
+
+    val_host_mp_stop(cpu_on, workers);
+
+    return ret;
 }
 
 /**
- *   @brief    Return the granule from NS mem track
- *   @param    PA         - Physical address of granule
- *   @return   Returns the granule for given PA from NS mem track
+ *   @brief    Map a protected range into a realm using all the cpus. The RTTs
+ *             down to level 2 are created first, then the range is split at
+ *             L2 boundaries so that each cpu creates its own level 3 RTTs and
+ *             DATA. The RIM of the realm depends on the order DATA is created
+ *             in, so it isn't reproducible with this mode.
+ *   @param    realm            - Realm strucrure
+ *   @param    data_create      - Data creation structure
+ *   @return   SUCCESS/FAILURE
 **/
-val_host_granule_ts *val_host_find_granule(uint64_t PA)
+uint32_t val_host_map_protected_data_parallel(val_host_realm_ts *realm,
+                                              val_data_create_ts *data_create)
 {
-    val_host_granule_ts *find = head;
+    bool cpu_on[PLATFORM_CPU_COUNT] = {false};
+    val_host_mp_work_ts *work;
+    uint64_t base = data_create->ipa, top = data_create->ipa + data_create->size;
+    uint64_t ipa, next, per_range, start;
+    uint32_t cpu_count = val_get_cpu_count();
+    uint32_t count = 0, workers, ret;
+
+    if (val_host_create_rtt_range(realm, base, top, VAL_RTT_MAX_LEVEL - 1,
+                                  data_create->rtt_alignment))
+        return VAL_ERROR;
+
+    mp_work = val_host_mem_alloc_tag(sizeof(uint64_t), (uint64_t)(cpu_count + 1) *
+                                     sizeof(val_host_mp_work_ts), VAL_HOST_MEM_TAG_TRACK);
+    if (mp_work == NULL)
+    {
+        LOG(ERROR, "Failed to allocate population work\n");
+        return VAL_ERROR;
+    }
 
-    while (find != NULL)
+    per_range = ADDR_ALIGN_DOWN(data_create->size / cpu_count + VAL_RTT_L2_BLOCK_SIZE - 1,
+                                VAL_RTT_L2_BLOCK_SIZE);
+    for (ipa = base; ipa < top; ipa = next)
     {
-        if (find->PA == PA)
-            return find;
-        find = find->next;
+        next = ADDR_ALIGN_DOWN(ipa + per_range, VAL_RTT_L2_BLOCK_SIZE);
+        if (next > top)
+            next = top;
+
+        work = val_host_mp_work_add(&count, VAL_HOST_MP_WORK_MAP_RANGE, realm->rd, ipa, next);
+        work->realm = realm;
+        work->target_pa = data_create->target_pa + (ipa - base);
+        work->src_pa = data_create->src_pa + (ipa - base);
+        work->rtt_alignment = data_create->rtt_alignment;
     }
 
-    return NULL;
+    start = val_read_cntpct_el0();
+    workers = val_host_mp_start(cpu_on);
+    ret = val_host_mp_phase(0, count, cpu_on, workers);
+    val_host_mp_stop(cpu_on, workers);
+
+    LOG(INFO, "Parallel population on %d cpus, ticks=0x%x\n", workers + 1,
+                                                        val_read_cntpct_el0() - start);
+    return ret;
 }
 
 /**
- *   @brief    Remove granule from given mem track list
- *   @param    gran_list_head      - head pointer of granule list
- *   @param    PA                  - Physical address of granule
- *   @return   Returns the removed granule from mem track list
+ *   @brief    Rollback the changes
+ *   @param    void
+ *   @return   SUCCESS/FAILURE
 **/
-val_host_granule_ts *val_host_remove_granule(val_host_granule_ts **gran_list_head, uint64_t PA)
+uint64_t val_host_postamble(void)
 {
-    val_host_granule_ts *current = *gran_list_head, *prev = NULL, *temp = NULL;
+    int i;
+    uint64_t ret, w, word, delegated, undelegated, PA;
+    val_host_granule_ts *curr_gran = NULL, *next_gran = NULL;
 
-    temp = mem_track[0].gran_type.ns;
+    if ((postamble_mode == VAL_HOST_POSTAMBLE_PARALLEL) && val_host_postamble_parallel())
+    {
+        LOG(ERROR, "Parallel postamble failed\n");
+        return VAL_ERROR;
+    }
 
-    if ((current != NULL) && (current->PA == PA))
+    for (i = 1 ; i < (int)mem_track_top ; i++)
     {
-        /* If its NS mem_track list update head */
-        if (temp == *gran_list_head)
+        if (mem_track[i].in_use)
         {
-            head = current->next;
-            mem_track[0].gran_type.ns = head;
-            current->next = NULL;
-            return current;
-        } else {
-            prev = current;
-            current = current->next;
-            *gran_list_head = current;
-            prev->next = NULL;
-            return prev;
+            ret = val_host_realm_destroy((uint64_t)mem_track[i].rd);
+            if (ret)
+            {
+                LOG(ERROR, "val_host_realm_destroy failed, ret=0x%x\n", ret);
+                return VAL_ERROR;
+            }
         }
     }
 
-    while (NULL != current)
+    //Return delegated granules of the memory pool to the granule pool and drop undelegated ones
+    for (w = 0; w < VAL_HOST_GRANULE_MAP_WORDS; w++)
     {
-        if (current->PA != PA)
+        word = granule_map[w];
+        delegated = word & ~(word >> 1) & VAL_HOST_GRANULE_MAP_LOW_BITS;
+        undelegated = (word >> 1) & ~word & VAL_HOST_GRANULE_MAP_LOW_BITS;
+
+        while (delegated != 0)
         {
-            prev = current;
-            current = current->next;
-        } else {
-            break;
+            PA = PLATFORM_MEMORY_POOL_BASE + (((w * VAL_HOST_GRANULE_MAP_PER_WORD) +
+                   ((uint64_t)__builtin_ctzll(delegated) / VAL_HOST_GRANULE_MAP_BITS)) <<
+                                                      VAL_HOST_GRANULE_MAP_SHIFT);
+            if (val_host_granule_pool_put(PA))
+                return VAL_ERROR;
+            delegated &= delegated - 1;
+        }
+
+        while (undelegated != 0)
+        {
+            PA = PLATFORM_MEMORY_POOL_BASE + (((w * VAL_HOST_GRANULE_MAP_PER_WORD) +
+                   ((uint64_t)__builtin_ctzll(undelegated) / VAL_HOST_GRANULE_MAP_BITS)) <<
+                                                      VAL_HOST_GRANULE_MAP_SHIFT);
+            val_host_granule_map_set(PA, VAL_HOST_GRANULE_MAP_NONE);
+            undelegated &= undelegated - 1;
         }
     }
 
-    if (current == NULL)
-        return NULL;
-    else if (current->PA == PA)
+    //Return all other delegated granules in NS mem_track to the granule pool
+    curr_gran = mem_track[0].gran_type.ns.head;
+    while (curr_gran != NULL)
     {
-        prev->next = current->next;
-        if (mem_track[0].gran_type.ns == *gran_list_head)
+        if (curr_gran->state == GRANULE_DELEGATED)
         {
-            if (current->next == NULL)
-                tail = prev;
+            next_gran = curr_gran->next;
+            if (val_host_granule_pool_put(curr_gran->PA))
+                return VAL_ERROR;
+            curr_gran = next_gran;
+        } else {
+            curr_gran = curr_gran->next;
         }
-        current->next = NULL;
-        return current;
+    }
+
+    //Free remaining memory from list
+    val_host_granule_ts *node_temp1 = NULL;
+
+    curr_gran = mem_track[0].gran_type.ns.head;
+    if (curr_gran == NULL)
+    {
+        return VAL_SUCCESS;
     } else {
-        return NULL;
+        while (curr_gran != NULL)
+        {
+            if (curr_gran->state == GRANULE_UNDELEGATED)
+            {
+                next_gran = curr_gran->next;
+                node_temp1 = val_host_remove_granule(&mem_track[0].gran_type.ns, curr_gran->PA);
+                if (val_host_granule_map_covers(node_temp1->PA))
+                    val_host_granule_map_set(node_temp1->PA, VAL_HOST_GRANULE_MAP_NONE);
+                val_host_track_node_free(node_temp1);
+                curr_gran = next_gran;
+
+            } else {
+                curr_gran = curr_gran->next;
+            }
+        }
     }
 
-    return NULL;
+    return VAL_SUCCESS;
+}
+
+/**
+ *   @brief    Split a block entry mapping DATA with an RTT one level down
+ *   @param    rd      -  Realm RD granule address
+ *   @param    ipa     -  IPA within the block
+ *   @param    level   -  Level of the new RTT
+ *   @return   SUCCESS/FAILURE
+**/
+static uint32_t val_host_data_block_split(uint64_t rd, uint64_t ipa, uint64_t level)
+{
+    uint64_t rtt, ret;
+
+    rtt = val_host_granule_pool_get(PAGE_SIZE);
+    if (!rtt)
+    {
+        LOG(ERROR, "Failed to get delegated granule for rtt\n");
+        return VAL_ERROR;
+    }
+
+    ret = val_host_rmi_rtt_create(rd, rtt, ADDR_ALIGN_DOWN(ipa, val_host_rtt_level_mapsize(level - 1)),
+                                  level);
+    if (ret)
+    {
+        LOG(ERROR, "Block split failed, ipa=0x%x, ret=0x%x\n", ipa, ret);
+        val_host_granule_pool_put(rtt);
+        return VAL_ERROR;
+    }
 
+    return VAL_SUCCESS;
 }
 
 /**
- *   @brief    Rollback mem_track state update
- *   @param    rd                - Realm RD
- *   @param    PA                - Physical address of granule
- *   @param    ipa               - IPA Address
- *   @param    level             - RTT level
- *   @param    state             - state of granule
- *   @param    gran_list_state   - granule list state
- *   @return   void
+ *   @brief    Destroy a DATA granule and its auxiliary mappings, and return it
+ *             to the granule pool
+ *   @param    gran    -  DATA granule node
+ *   @param    top     -  Top IPA of non-live RTT entries after the granule
+ *   @return   SUCCESS/FAILURE
 **/
-void val_host_update_destroy_granule_state(uint64_t rd, uint64_t PA,
-                                       uint64_t ipa, uint64_t level,
-                           uint32_t state, uint32_t gran_list_state, uint64_t rtt_tree_idx)
+static uint32_t val_host_data_granule_destroy(val_host_granule_ts *gran, uint64_t *top)
 {
-    val_host_granule_ts *node = NULL;
-    int i;
+    val_host_data_destroy_ts data_destroy;
+    val_smc_param_ts cmd_ret;
+    uint64_t ret, i, PA;
 
-    if (state == GRANULE_UNDELEGATED)
+    /* DATA_DESTROY needs a page entry, split the block mapping the granule */
+    while (gran->level != 0 && gran->level < VAL_RTT_MAX_LEVEL)
     {
-        node = val_host_find_granule(PA);
-        if (node != NULL)
+        if (val_host_data_block_split(gran->rd, gran->ipa, gran->level + 1))
+            return VAL_ERROR;
+    }
+
+    /* Destroy mappings in Auxilliary Mapping */
+    for (i = 0; i < VAL_MAX_AUX_PLANES; i++)
+    {
+        if (gran->has_auxiliary[i])
         {
-            if (node->is_granule_sliced == 0)
+            cmd_ret = val_host_rmi_rtt_aux_unmap_protected(gran->rd, gran->ipa, i + 1);
+            if (cmd_ret.x0)
             {
-                node = val_host_remove_granule(&mem_track[0].gran_type.ns, PA);
-                val_host_mem_free((void *)node->PA);
-                val_host_mem_free(node);
-                return;
-            } else if (node->is_granule_sliced == 1) {
-                     node->state = state;
+                LOG(ERROR, "RTT_AUX_UNMAP_PROTECTED failed for ipa=0x%x, ret=0x%x\n",
+                                                                   gran->ipa, cmd_ret.x0);
+                return VAL_ERROR;
             }
         }
-        return;
     }
 
-    if (gran_list_state != GRANULE_REC)
+    /* The node is released once the granule is back in the NS mem_track */
+    PA = gran->PA;
+    ret = val_host_rmi_data_destroy(gran->rd, gran->ipa, &data_destroy);
+    if (ret)
     {
-        current_realm = val_host_get_curr_realm(rd);
+        LOG(ERROR, "Data destroy failed, data=0x%x, ret=0x%x\n", PA, ret);
+        return VAL_ERROR;
     }
+    *top = data_destroy.top;
 
-    switch (gran_list_state)
-    {
-        case GRANULE_RTT:
-            node = val_host_remove_rtt_granule(&mem_track[current_realm].gran_type.rtt, ipa, level);
-            node->state = state;
-            val_host_add_granule(state, node->PA, node);
-            break;
-
-        case GRANULE_RTT_AUX:
-            node = val_host_remove_aux_rtt_granule(&mem_track[current_realm].gran_type.rtt_aux,
-                                                                         ipa, level, rtt_tree_idx);
-            node->state = state;
-            val_host_add_granule(state, node->PA, node);
-            break;
+    return val_host_granule_pool_put(PA);
+}
 
-        case GRANULE_DATA:
-            node = val_host_remove_data_granule(&mem_track[current_realm].gran_type.data, ipa);
-            node->state = state;
-            val_host_add_granule(state, node->PA, node);
-            break;
+/**
+ *   @brief    Unmap an unprotected granule and its auxiliary mappings
+ *   @param    gran    -  Unprotected granule node
+ *   @param    top     -  Top IPA of non-live RTT entries after the granule
+ *   @return   SUCCESS/FAILURE
+**/
+static uint32_t val_host_unprotected_granule_unmap(val_host_granule_ts *gran, uint64_t *top)
+{
+    val_smc_param_ts cmd_ret;
+    uint64_t ret, i;
 
-        case GRANULE_REC:
-            for (i = 1; i < VAL_HOST_MAX_REALMS; i++)
+    /* Unmap Auxilliary mappings for Unprotected IPA */
+    for (i = 0; i < VAL_MAX_AUX_PLANES; i++)
+    {
+        if (gran->has_auxiliary[i])
+        {
+            cmd_ret = val_host_rmi_rtt_aux_unmap_unprotected(gran->rd, gran->ipa, i + 1);
+            if (cmd_ret.x0)
             {
-                node = val_host_remove_granule(&mem_track[i].gran_type.rec, PA);
-                if (node != NULL)
-                {
-                    node->state = state;
-                    val_host_add_granule(state, PA, node);
-                    break;
-                }
+                LOG(ERROR, "val_rmi_rtt_aux_unmap_unprotected failed, ipa=0x%x, ret=0x%x\n",
+                                                                     gran->ipa, cmd_ret.x0);
+                return VAL_ERROR;
             }
-            break;
-
-        case GRANULE_RD:
-            node = val_host_remove_granule(&mem_track[current_realm].gran_type.rd, PA);
-            node->state = state;
-            val_host_add_granule(state, PA, node);
-            mem_track[current_realm].rd = 0x00000000FFFFFFFF;
-            break;
+        }
+    }
 
-        case GRANULE_UNPROTECTED:
-            node = val_host_remove_granule(&mem_track[current_realm].gran_type.valid_ns, PA);
-            node->state = GRANULE_UNDELEGATED;
-            val_host_add_granule(state, PA, node);
-            break;
+    ret = val_host_rmi_rtt_unmap_unprotected(gran->rd, gran->ipa, gran->level, top);
+    if (ret)
+    {
+        LOG(ERROR, "val_rmi_rtt_unmap_unprotected failed, ipa=0x%x, ret=0x%x\n", gran->ipa, ret);
+        return VAL_ERROR;
     }
+
+    return VAL_SUCCESS;
 }
 
 /**
- *   @brief    Remove data granule from data list and add to the NS mem_track
- *   @param    gran_list_head      - Data granule which needs to remove from data list
- *                                   and add to NS mem track
- *   @param    ipa                 - IPA which needs to remove from data list
- *   @return   Returns the node from data list
+ *   @brief    Destroy DATA granules and unmap unprotected granules of a realm
+ *             in IPA order. DATA granules are returned to the granule pool.
+ *   @param    rd      -  Realm RD granule address
+ *   @param    base    -  Base of the IPA range
+ *   @param    top     -  Top of the IPA range, exclusive
+ *   @return   SUCCESS/FAILURE
 **/
-val_host_granule_ts *val_host_remove_data_granule(val_host_granule_ts **gran_list_head,
-                                                                          uint64_t ipa)
+uint32_t val_host_realm_unmap_range(uint64_t rd, uint64_t base, uint64_t top)
 {
-    val_host_granule_ts *current = *gran_list_head, *prev = NULL, *temp = NULL;
+    val_host_granule_ts *curr_gran;
+    int realm_idx = val_host_realm_lookup(rd);
+    uint64_t ipa, rtt_top;
 
-    temp = mem_track[0].gran_type.ns;
-    if ((current != NULL) && (current->ipa == ipa))
+    if (realm_idx == 0)
     {
-        if (temp == *gran_list_head)
-        {
-            head = current->next;
-            mem_track[0].gran_type.ns = head;
-            current->next = NULL;
-            return current;
-        } else {
-            prev = current;
-            current = current->next;
-            *gran_list_head = current;
-            prev->next = NULL;
-            return prev;
-        }
+        LOG(ERROR, "Realm not tracked, rd=0x%x\n", rd);
+        return VAL_ERROR;
     }
 
-    while (NULL != current)
+    ipa = base;
+    while ((curr_gran = val_host_next_ipa_granule_below(&mem_track[realm_idx].gran_type.data,
+                                                        ipa, top)) != NULL)
     {
-        if (current->ipa != ipa)
-        {
-            prev = current;
-            current = current->next;
-        } else {
-            break;
-        }
+        ipa = curr_gran->ipa + PAGE_SIZE;
+        if (val_host_data_granule_destroy(curr_gran, &rtt_top))
+            return VAL_ERROR;
     }
 
-    if (current == NULL)
-        return NULL;
-    else if (current->ipa == ipa)
+    ipa = base;
+    while ((curr_gran = val_host_next_ipa_granule_below(&mem_track[realm_idx].gran_type.valid_ns,
+                                                        ipa, top)) != NULL)
     {
-        prev->next = current->next;
-        if (mem_track[0].gran_type.ns == *gran_list_head)
-        {
-            if (current->next == NULL)
-                tail = prev;
-        }
-        current->next = NULL;
-        return current;
-    } else {
-        return NULL;
+        ipa = curr_gran->ipa + PAGE_SIZE;
+        if (val_host_unprotected_granule_unmap(curr_gran, &rtt_top))
+            return VAL_ERROR;
     }
 
-    return NULL;
+    return VAL_SUCCESS;
 }
 
 /**
- *   @brief    Remove data granule from data list and add to the NS mem_track
- *   @param    gran_list_head      - Data granule which needs to remove from data list
- *                                   and add to NS mem track
- *   @param    ipa                 - IPA which needs to remove from data list
- *   @return   Returns the node from data list
+ *   @brief    Set how val_host_realm_destroy tears down the RTTs and mappings
+ *             of a realm. The mode is reset to VAL_HOST_TEARDOWN_LISTS for
+ *             every test.
+ *   @param    mode    -  Teardown mode
+ *   @return   void
 **/
-val_host_granule_ts *val_host_remove_rtt_granule(val_host_granule_ts **gran_list_head,
-                                                         uint64_t ipa, uint64_t level)
+void val_host_realm_teardown_mode_set(val_host_teardown_mode_te mode)
 {
-    val_host_granule_ts *current = *gran_list_head, *prev = NULL, *temp = NULL;
+    teardown_mode = mode;
+}
 
-    temp = mem_track[0].gran_type.ns;
-    if ((current != NULL) && (current->level == level) && (current->ipa == ipa))
-    {
-        if (temp == *gran_list_head)
-        {
-            head = current->next;
-            mem_track[0].gran_type.ns = head;
-            current->next = NULL;
-            return current;
-        } else {
-            prev = current;
-            current = current->next;
-            *gran_list_head = current;
-            prev->next = NULL;
-            return prev;
-        }
-    }
+/**
+ *   @brief    Record the IPA space of a realm for the RTT walk teardown
+ *   @param    rd              -  Realm RD granule address
+ *   @param    ipa_width       -  IPA width of the realm
+ *   @param    rtt_level_start -  Level of the starting level RTTs
+ *   @return   void
+**/
+void val_host_track_realm_params(uint64_t rd, uint64_t ipa_width, uint64_t rtt_level_start)
+{
+    int realm;
 
-    while (NULL != current)
+    val_spin_lock(&track_lock);
+    realm = val_host_get_curr_realm(rd);
+    if (realm != 0)
     {
-        if ((current->level != level) || (current->ipa != ipa))
-        {
-            prev = current;
-            current = current->next;
-        } else {
-            break;
-        }
+        mem_track[realm].ipa_width = ipa_width;
+        mem_track[realm].rtt_level_start = rtt_level_start;
     }
+    val_spin_unlock(&track_lock);
+}
 
-    if (current == NULL)
-        return NULL;
-    else if ((current->level == level) && (current->ipa == ipa))
+/**
+ *   @brief    Compare two RTTs. In post order an RTT follows all the RTTs it
+ *             contains, otherwise RTTs are ordered by IPA.
+ *   @param    a           -  RTT
+ *   @param    b           -  RTT
+ *   @param    post_order  -  Order to use
+ *   @return   Returns true if a goes before b
+**/
+static bool val_host_rtt_ref_before(val_host_rtt_ref_ts *a, val_host_rtt_ref_ts *b,
+                                    bool post_order)
+{
+    uint64_t a_end, b_end;
+
+    if (!post_order)
+        return a->ipa < b->ipa;
+
+    a_end = a->ipa + val_host_rtt_level_mapsize(a->level - 1);
+    b_end = b->ipa + val_host_rtt_level_mapsize(b->level - 1);
+    if (a_end != b_end)
+        return a_end < b_end;
+
+    return a->level > b->level;
+}
+
+static void val_host_rtt_refs_sift(val_host_rtt_ref_ts *refs, uint64_t root, uint64_t count,
+                                   bool post_order)
+{
+    val_host_rtt_ref_ts tmp;
+    uint64_t child;
+
+    while ((child = (2 * root) + 1) < count)
     {
-        prev->next = current->next;
-        if (mem_track[0].gran_type.ns == *gran_list_head)
-        {
-            if (current->next == NULL)
-                tail = prev;
-        }
-        current->next = NULL;
-        return current;
-    } else {
-        return NULL;
-    }
+        if ((child + 1 < count) && val_host_rtt_ref_before(&refs[child], &refs[child + 1],
+                                                           post_order))
+            child++;
 
-    return NULL;
+        if (!val_host_rtt_ref_before(&refs[root], &refs[child], post_order))
+            return;
+
+        tmp = refs[root];
+        refs[root] = refs[child];
+        refs[child] = tmp;
+        root = child;
+    }
 }
 
 /**
- *   @brief    Remove data granule from data list and add to the NS mem_track
- *   @param    gran_list_head      - Data granule which needs to remove from data list
- *                                   and add to NS mem track
- *   @param    ipa                 - IPA which needs to remove from data list
- *   @return   Returns the node from data list
+ *   @brief    Collect the tracked RTTs of a realm tree, sorted with heapsort
+ *   @param    gran_list   -  RTT or auxiliary RTT list of the realm
+ *   @param    tree_idx    -  RTT tree index, 0 for the primary tree
+ *   @param    post_order  -  Sort in post order rather than by IPA
+ *   @param    count       -  Number of RTTs collected
+ *   @return   Returns the RTT array, to be freed by the caller, or NULL on failure
 **/
-val_host_granule_ts *val_host_remove_aux_rtt_granule(val_host_granule_ts **gran_list_head,
-                                                uint64_t ipa, uint64_t level, uint64_t index)
+static val_host_rtt_ref_ts *val_host_rtt_refs_collect(val_host_granule_list_ts *gran_list,
+                                 uint64_t tree_idx, bool post_order, uint64_t *count)
 {
-    val_host_granule_ts *current = *gran_list_head, *prev = NULL, *temp = NULL;
+    val_host_rtt_ref_ts *refs, tmp;
+    val_host_granule_ts *curr_gran;
+    uint64_t i;
 
-    temp = mem_track[0].gran_type.ns;
-    if ((current != NULL) && (current->level == level) &&
-                             (current->ipa == ipa) && (current->rtt_tree_idx == index))
+    refs = val_host_mem_alloc_tag(sizeof(uint64_t),
+                     (gran_list->count + 1) * sizeof(val_host_rtt_ref_ts), VAL_HOST_MEM_TAG_TRACK);
+    if (refs == NULL)
     {
-        if (temp == *gran_list_head)
-        {
-            head = current->next;
-            mem_track[0].gran_type.ns = head;
-            current->next = NULL;
-            return current;
-        } else {
-            prev = current;
-            current = current->next;
-            *gran_list_head = current;
-            prev->next = NULL;
-            return prev;
-        }
+        LOG(ERROR, "Failed to allocate %d RTT references\n", gran_list->count);
+        return NULL;
     }
 
-    while (NULL != current)
+    *count = 0;
+    for (curr_gran = gran_list->head; curr_gran != NULL; curr_gran = curr_gran->next)
     {
-        if ((current->level != level) || (current->ipa != ipa) || (current->rtt_tree_idx != index))
-        {
-            prev = current;
-            current = current->next;
-        } else {
-            break;
-        }
+        if (curr_gran->rtt_tree_idx != tree_idx)
+            continue;
+
+        refs[*count].ipa = curr_gran->ipa;
+        refs[*count].level = curr_gran->level;
+        refs[*count].PA = curr_gran->PA;
+        (*count)++;
     }
 
-    if (current == NULL)
-        return NULL;
-    else if ((current->level == level) && (current->ipa == ipa) && (current->rtt_tree_idx == index))
+    for (i = *count / 2; i > 0; i--)
+        val_host_rtt_refs_sift(refs, i - 1, *count, post_order);
+
+    for (i = *count; i > 1; i--)
     {
-        prev->next = current->next;
-        if (mem_track[0].gran_type.ns == *gran_list_head)
-        {
-            if (current->next == NULL)
-                tail = prev;
-        }
-        current->next = NULL;
-        return current;
-    } else {
-        return NULL;
+        tmp = refs[0];
+        refs[0] = refs[i - 1];
+        refs[i - 1] = tmp;
+        val_host_rtt_refs_sift(refs, 0, i - 1, post_order);
+    }
+
+    return refs;
+}
+
+/**
+ *   @brief    Find the lowest IPA not below ipa with a tracked mapping or RTT
+ *   @param    walk    -  Teardown state
+ *   @param    ipa     -  Lowest IPA
+ *   @return   Returns the IPA, or UINT64_MAX if there is none
+**/
+static uint64_t val_host_rtt_walk_next(val_host_rtt_walk_ts *walk, uint64_t ipa)
+{
+    val_host_granule_ts *gran;
+    uint64_t lo = 0, hi = walk->rtt_count, mid, next = UINT64_MAX;
+
+    while (lo < hi)
+    {
+        mid = lo + ((hi - lo) / 2);
+        if (walk->rtts[mid].ipa < ipa)
+            lo = mid + 1;
+        else
+            hi = mid;
     }
+    if (lo < walk->rtt_count)
+        next = walk->rtts[lo].ipa;
 
-    return NULL;
+    gran = val_host_next_ipa_granule(&mem_track[walk->realm].gran_type.data, ipa);
+    if ((gran != NULL) && (gran->ipa < next))
+        next = gran->ipa;
+
+    gran = val_host_next_ipa_granule(&mem_track[walk->realm].gran_type.valid_ns, ipa);
+    if ((gran != NULL) && (gran->ipa < next))
+        next = gran->ipa;
+
+    return next;
 }
 
+static uint32_t val_host_rtt_walk_table(val_host_rtt_walk_ts *walk, uint64_t base,
+                                        uint64_t end, uint64_t level);
+
 /**
- *   @brief    Destroy rtt levels
- *   @param    rtt_level      - RTT level to destroy
- *   @param    current_realm  - current realm index in mem track
+ *   @brief    Destroy an emptied RTT and return it to the granule pool. If the
+ *             RTT still has live entries the host doesn't track, its range is
+ *             walked entry by entry before retrying.
+ *   @param    walk    -  Teardown state
+ *   @param    ipa     -  Base IPA of the RTT
+ *   @param    level   -  Level of the RTT
+ *   @param    top     -  Top IPA of non-live entries after the RTT
  *   @return   SUCCESS/FAILURE
 **/
-uint64_t val_host_destroy_rtt_levels(uint64_t rtt_level, int current_realm)
+static uint32_t val_host_rtt_walk_destroy(val_host_rtt_walk_ts *walk, uint64_t ipa,
+                                          uint64_t level, uint64_t *top)
 {
-    val_host_granule_ts *curr_gran = NULL, *next_gran = NULL;
-    uint64_t ret;
     val_host_rtt_destroy_ts rtt_destroy;
+    uint64_t ret;
+    uint32_t status;
 
-    curr_gran = mem_track[current_realm].gran_type.rtt;
-    while (curr_gran != NULL)
+    ret = val_host_rmi_rtt_destroy(walk->rd, ipa, level, &rtt_destroy);
+    if ((RMI_STATUS(ret) == RMI_ERROR_RTT) && !walk->exhaustive)
     {
-        next_gran = curr_gran->next;
-        if (curr_gran->level == rtt_level)
-        {
+        walk->exhaustive = true;
+        status = val_host_rtt_walk_table(walk, ipa, ipa + val_host_rtt_level_mapsize(level - 1),
+                                                                                        level);
+        walk->exhaustive = false;
+        if (status)
+            return VAL_ERROR;
 
-            ret = val_host_rmi_rtt_destroy(curr_gran->rd,
-                                           curr_gran->ipa, curr_gran->level, &rtt_destroy);
-            if (ret)
-            {
-                LOG(ERROR, "realm_rtt_destroy failed, rtt=0x%x, ret=0x%x\n", curr_gran->ipa, ret);
-                return VAL_ERROR;
-            }
-            ret = val_host_rmi_granule_undelegate(curr_gran->PA);
-            if (ret)
-            {
-                LOG(ERROR, "val_rmi_granule_undelegate failed, rtt=0x%x, ret=0x%x\n",
-                                                                   curr_gran->PA, ret);
-                return VAL_ERROR;
-            }
+        ret = val_host_rmi_rtt_destroy(walk->rd, ipa, level, &rtt_destroy);
+    }
 
-            curr_gran = next_gran;
-        } else {
-            curr_gran = next_gran;
-        }
+    if (ret)
+    {
+        LOG(ERROR, "realm_rtt_destroy failed, rtt=0x%x, ret=0x%x\n", ipa, ret);
+        return VAL_ERROR;
     }
-    return VAL_SUCCESS;
+
+    *top = rtt_destroy.top;
+    return val_host_granule_pool_put(rtt_destroy.rtt);
 }
 
 /**
- *   @brief    Destroy auxiliary rtt levels
- *   @param    rtt_level      - RTT level to destroy
- *   @param    current_realm  - current realm index in mem track
+ *   @brief    Tear down the entries of an RTT depth first. Only entries with a
+ *             tracked mapping or RTT under them are read, and the top IPA
+ *             returned by each destroy skips the non-live entries that follow.
+ *   @param    walk    -  Teardown state
+ *   @param    base    -  Base IPA of the RTT
+ *   @param    end     -  Top IPA of the RTT, exclusive
+ *   @param    level   -  Level of the RTT
  *   @return   SUCCESS/FAILURE
 **/
-uint64_t val_host_destroy_aux_rtt_levels(uint64_t rtt_level, int current_realm, uint64_t index)
+static uint32_t val_host_rtt_walk_table(val_host_rtt_walk_ts *walk, uint64_t base,
+                                        uint64_t end, uint64_t level)
 {
-    val_host_granule_ts *curr_gran = NULL, *next_gran = NULL;
-    uint64_t ret;
-    val_smc_param_ts cmd_ret;
+    val_host_rtt_entry_ts entry;
+    val_host_data_destroy_ts data_destroy;
+    val_host_granule_ts *gran;
+    uint64_t size = val_host_rtt_level_mapsize(level);
+    uint64_t ipa = base, next, top, ret;
 
-    curr_gran = mem_track[current_realm].gran_type.rtt_aux;
-    while (curr_gran != NULL)
+    while (ipa < end)
     {
-        next_gran = curr_gran->next;
-        if ((curr_gran->level == rtt_level) && (curr_gran->rtt_tree_idx == index))
+        if (!walk->exhaustive)
         {
+            next = val_host_rtt_walk_next(walk, ipa);
+            if (next >= end)
+                break;
+            if (ADDR_ALIGN_DOWN(next, size) > ipa)
+                ipa = ADDR_ALIGN_DOWN(next, size);
+        }
 
-            cmd_ret = val_host_rmi_rtt_aux_destroy(curr_gran->rd,
-                                           curr_gran->ipa, curr_gran->level, index);
-            if (cmd_ret.x0)
-            {
-                LOG(ERROR, "realm_rtt_destroy failed, rtt=0x%x, ret=0x%x\n", curr_gran->ipa,
-                                                                                 cmd_ret.x0);
-                return VAL_ERROR;
-            }
+        ret = val_host_rmi_rtt_read_entry(walk->rd, ipa, level, &entry);
+        if (ret || entry.walk_level != level)
+        {
+            LOG(ERROR, "RTT_READ_ENTRY failed, ipa=0x%x, ret=0x%x\n", ipa, ret);
+            return VAL_ERROR;
+        }
 
-            ret = val_host_rmi_granule_undelegate(curr_gran->PA);
+        top = ipa + size;
+        if (entry.state == RMI_TABLE)
+        {
+            if (val_host_rtt_walk_table(walk, ipa, ipa + size, level + 1))
+                return VAL_ERROR;
+            if (val_host_rtt_walk_destroy(walk, ipa, level + 1, &top))
+                return VAL_ERROR;
+        } else if (entry.state == RMI_ASSIGNED && ipa >= walk->unprotected_base) {
+            gran = val_host_find_ipa_granule(&mem_track[walk->realm].gran_type.valid_ns, ipa);
+            if (gran != NULL)
+                ret = val_host_unprotected_granule_unmap(gran, &top);
+            else
+                ret = val_host_rmi_rtt_unmap_unprotected(walk->rd, ipa, level, &top);
             if (ret)
             {
-                LOG(ERROR, "val_rmi_granule_undelegate failed, rtt=0x%x, ret=0x%x\n",
-                                                                   curr_gran->PA, ret);
+                LOG(ERROR, "Unprotected unmap failed, ipa=0x%x, ret=0x%x\n", ipa, ret);
                 return VAL_ERROR;
             }
+        } else if (entry.state == RMI_ASSIGNED) {
+            if (level != VAL_RTT_MAX_LEVEL)
+            {
+                /* Split the block and tear down the page entries */
+                if (val_host_data_block_split(walk->rd, ipa, level + 1) ||
+                    val_host_rtt_walk_table(walk, ipa, ipa + size, level + 1) ||
+                    val_host_rtt_walk_destroy(walk, ipa, level + 1, &top))
+                    return VAL_ERROR;
 
-            curr_gran = next_gran;
-        } else {
-            curr_gran = next_gran;
+                ipa = (top > ipa + size) ? top : ipa + size;
+                continue;
+            }
+
+            gran = val_host_find_ipa_granule(&mem_track[walk->realm].gran_type.data, ipa);
+            if (gran != NULL)
+            {
+                if (val_host_data_granule_destroy(gran, &top))
+                    return VAL_ERROR;
+            } else {
+                ret = val_host_rmi_data_destroy(walk->rd, ipa, &data_destroy);
+                if (ret)
+                {
+                    LOG(ERROR, "Data destroy failed, ipa=0x%x, ret=0x%x\n", ipa, ret);
+                    return VAL_ERROR;
+                }
+                top = data_destroy.top;
+                if (val_host_granule_pool_put(data_destroy.data))
+                    return VAL_ERROR;
+            }
         }
+
+        ipa = (top > ipa + size) ? top : ipa + size;
     }
+
     return VAL_SUCCESS;
 }
 
 /**
- *   @brief    Rollback the changes
- *   @param    void
+ *   @brief    Tear down the mappings and RTTs of a realm with one depth first
+ *             walk of each RTT tree. Auxiliary trees hold no mappings once the
+ *             primary tree is torn down, so their RTTs are destroyed in post
+ *             order from the tracking list.
+ *   @param    realm   -  Realm index in mem track
  *   @return   SUCCESS/FAILURE
 **/
-uint64_t val_host_postamble(void)
+static uint32_t val_host_realm_rtt_walk_teardown(int realm)
 {
-    int i;
-    uint64_t ret;
-    val_host_granule_ts *curr_gran = NULL, *next_gran = NULL;
+    val_host_rtt_walk_ts walk;
+    uint32_t status;
+#ifdef RMM_V_1_1
+    val_host_rtt_ref_ts *refs;
+    val_smc_param_ts cmd_ret;
+    uint64_t i, j, count;
+#endif
 
-    for (i = 1 ; i < VAL_HOST_MAX_REALMS ; i++)
-    {
-        if (mem_track[i].rd != 0x00000000FFFFFFFF)
-        {
-            ret = val_host_realm_destroy((uint64_t)mem_track[i].rd);
-            if (ret)
-            {
-                LOG(ERROR, "val_host_realm_destroy failed, ret=0x%x\n", ret);
-                return VAL_ERROR;
-            }
-        }
-    }
+    walk.rd = mem_track[realm].rd;
+    walk.realm = realm;
+    walk.unprotected_base = 1UL << (mem_track[realm].ipa_width - 1);
+    walk.exhaustive = false;
+    walk.rtts = val_host_rtt_refs_collect(&mem_track[realm].gran_type.rtt, 0, false,
+                                          &walk.rtt_count);
+    if (walk.rtts == NULL)
+        return VAL_ERROR;
 
-    //Undelegate and free all other granules in NS mem_track
-    curr_gran = mem_track[0].gran_type.ns;
-    while (curr_gran != NULL)
-    {
-        if (curr_gran->state == GRANULE_DELEGATED)
-        {
-            next_gran = curr_gran->next;
-            ret = val_host_rmi_granule_undelegate(curr_gran->PA);
-            if (ret)
-            {
-                LOG(ERROR, "granule undelegation failed, pa=0x%x, ret=0x%x\n",
-                                                            curr_gran->PA, ret);
-                return VAL_ERROR;
-            }
-            curr_gran = next_gran;
-        } else {
-            curr_gran = curr_gran->next;
-        }
-    }
+    status = val_host_rtt_walk_table(&walk, 0, 1UL << mem_track[realm].ipa_width,
+                                     mem_track[realm].rtt_level_start);
+    val_host_mem_free(walk.rtts);
+    if (status)
+        return VAL_ERROR;
 
-    //Free remaining memory from list
-    val_host_granule_ts *node_temp1 = NULL;
+#ifdef RMM_V_1_1
+    if (!val_host_rmm_supports_planes())
+        return VAL_SUCCESS;
 
-    curr_gran = mem_track[0].gran_type.ns;
-    if (curr_gran == NULL)
+    for (i = 0; i < VAL_MAX_AUX_PLANES; i++)
     {
-        return VAL_SUCCESS;
-    } else {
-        while (curr_gran != NULL)
+        refs = val_host_rtt_refs_collect(&mem_track[realm].gran_type.rtt_aux, i + 1, true,
+                                         &count);
+        if (refs == NULL)
+            return VAL_ERROR;
+
+        for (j = 0; j < count; j++)
         {
-            if (curr_gran->state == GRANULE_UNDELEGATED)
+            cmd_ret = val_host_rmi_rtt_aux_destroy(walk.rd, refs[j].ipa, refs[j].level, i + 1);
+            if (cmd_ret.x0 || val_host_granule_pool_put(refs[j].PA))
             {
-                next_gran = curr_gran->next;
-                node_temp1 = val_host_remove_granule(&mem_track[0].gran_type.ns, curr_gran->PA);
-                val_host_mem_free((void *)node_temp1->PA);
-                val_host_mem_free(node_temp1);
-                curr_gran = next_gran;
-
-            } else {
-                curr_gran = curr_gran->next;
+                LOG(ERROR, "realm_rtt_aux_destroy failed, rtt=0x%x, ret=0x%x\n", refs[j].ipa,
+                                                                             cmd_ret.x0);
+                val_host_mem_free(refs);
+                return VAL_ERROR;
             }
         }
+        val_host_mem_free(refs);
     }
+#endif
 
     return VAL_SUCCESS;
 }
@@ -2152,177 +4396,86 @@ uint64_t val_host_postamble(void)
 uint32_t val_host_realm_destroy(uint64_t rd)
 {
     uint64_t ret;
-    val_smc_param_ts cmd_ret;
     val_host_granule_ts *curr_gran = NULL, *next_gran = NULL;
-    val_host_data_destroy_ts data_destroy;
-    current_realm = val_host_get_curr_realm(rd);
-    uint64_t top;
+    int realm_idx = val_host_realm_lookup(rd);
+    bool shadow_mismatch = mem_track[realm_idx].rtt_shadow_mismatch;
+    uint64_t ipa, PA, top;
     uint64_t i;
 
-    /* For each REC - Destroy, undelegate */
-    curr_gran = mem_track[current_realm].gran_type.rec;
+    /* For each REC - Destroy, return to granule pool */
+    curr_gran = mem_track[realm_idx].gran_type.rec.head;
     while (curr_gran != NULL)
     {
         next_gran = curr_gran->next;
-        ret = val_host_rmi_rec_destroy(curr_gran->PA);
+        PA = curr_gran->PA;
+        ret = val_host_rmi_rec_destroy(PA);
         if (ret)
         {
-            LOG(ERROR, "REC destroy failed, rec=0x%x, ret=0x%x\n", curr_gran->PA, ret);
+            LOG(ERROR, "REC destroy failed, rec=0x%x, ret=0x%x\n", PA, ret);
             return VAL_ERROR;
         }
 
-        ret = val_host_rmi_granule_undelegate(curr_gran->PA);
-        if (ret)
-        {
-            LOG(ERROR, "rec undelegation failed, rec=0x%x, ret=0x%x\n", curr_gran->PA, ret);
+        if (val_host_granule_pool_put(PA))
             return VAL_ERROR;
-        }
        curr_gran = next_gran;
     }
 
-    // Destroy and undelegate realm protected granules
-    curr_gran = mem_track[current_realm].gran_type.data;
-    while (curr_gran != NULL)
+    // Destroy realm protected granules in IPA order, sliced granules first
+    ipa = 0;
+    while ((curr_gran = val_host_next_ipa_granule(&mem_track[realm_idx].gran_type.data, ipa))
+                                                                                    != NULL)
     {
-        next_gran = curr_gran->next;
-        if (curr_gran->is_granule_sliced == 1)
-        {
-
-            for (i = 0; i < VAL_MAX_AUX_PLANES; i++)
-            {
-                if (curr_gran->has_auxiliary[i])
-                {
-                    cmd_ret = val_host_rmi_rtt_aux_unmap_protected(curr_gran->rd,
-                                                               curr_gran->ipa, i + 1);
-                    if (cmd_ret.x0)
-                    {
-                        LOG(ERROR, "RTT_AUX_UNMAP_PROTECTED failed for ipa=0x%x, ret=0x%x\n",
-                                                                   curr_gran->ipa, cmd_ret.x0);
-                        return VAL_ERROR;
-                    }
-                }
-            }
-
-            ret = val_host_rmi_data_destroy(curr_gran->rd, curr_gran->ipa, &data_destroy);
-            if (ret)
-            {
-                LOG(ERROR, "Data destroy failed, data=0x%x, ret=0x%x\n", curr_gran->PA, ret);
-                return VAL_ERROR;
-            }
-
-            ret = val_host_rmi_granule_undelegate(curr_gran->PA);
-            if (ret)
-            {
-                LOG(ERROR, "data undelegation failed, pa=0x%x, ret=0x%x\n", curr_gran->PA, ret);
-                return VAL_ERROR;
-            }
-        }
-        curr_gran = next_gran;
+        ipa = curr_gran->ipa + PAGE_SIZE;
+        if (curr_gran->is_granule_sliced == 1 && val_host_data_granule_destroy(curr_gran, &top))
+            return VAL_ERROR;
     }
 
-    curr_gran = mem_track[current_realm].gran_type.data;
-    while (curr_gran != NULL)
+    if ((teardown_mode == VAL_HOST_TEARDOWN_RTT_WALK) && (mem_track[realm_idx].ipa_width != 0) &&
+        (mem_track[realm_idx].rtt_level_start <= VAL_RTT_MAX_LEVEL))
     {
-        next_gran = curr_gran->next;
-        if (curr_gran->is_granule_sliced == 0)
+        if (val_host_realm_rtt_walk_teardown(realm_idx))
+            return VAL_ERROR;
+    } else {
+        if (val_host_realm_unmap_range(rd, 0, UINT64_MAX))
+            return VAL_ERROR;
+
+        // Destroy leaf rtt hirerachy
+        if (val_host_destroy_rtt_levels(3, realm_idx))
+            return VAL_ERROR;
+        if (val_host_destroy_rtt_levels(2, realm_idx))
+            return VAL_ERROR;
+        if (val_host_destroy_rtt_levels(1, realm_idx))
+            return VAL_ERROR;
+
+#ifdef RMM_V_1_1
+        /* Destroy Auxiliary RTTs */
+        if (val_host_rmm_supports_planes())
         {
-            /* Destroy mappings in Auxilliary Mapping */
             for (i = 0; i < VAL_MAX_AUX_PLANES; i++)
             {
-                if (curr_gran->has_auxiliary[i])
-                {
-                    cmd_ret = val_host_rmi_rtt_aux_unmap_protected(curr_gran->rd,
-                                                               curr_gran->ipa, i + 1);
-                    if (cmd_ret.x0)
-                    {
-                        LOG(ERROR, "RTT_AUX_UNMAP_PROTECTED failed for ipa=0x%x, ret=0x%x\n",
-                                                                      curr_gran->ipa, cmd_ret.x0);
+                    if (val_host_destroy_aux_rtt_levels(3, realm_idx, i + 1))
+                        return VAL_ERROR;
+                    if (val_host_destroy_aux_rtt_levels(2, realm_idx, i + 1))
+                        return VAL_ERROR;
+                    if (val_host_destroy_aux_rtt_levels(1, realm_idx, i + 1))
                         return VAL_ERROR;
-                    }
-                }
-            }
-
-            ret = val_host_rmi_data_destroy(curr_gran->rd, curr_gran->ipa, &data_destroy);
-            if (ret)
-            {
-                LOG(ERROR, "Data destroy failed, data=0x%x, ret=0x%x\n", curr_gran->PA, ret);
-                return VAL_ERROR;
-            }
-
-            ret = val_host_rmi_granule_undelegate(curr_gran->PA);
-            if (ret)
-            {
-                LOG(ERROR, "data undelegation failed, pa=0x%x, ret=0x%x\n", curr_gran->PA, ret);
-                return VAL_ERROR;
             }
-            curr_gran = next_gran;
-        } else {
-            curr_gran = next_gran;
         }
+#endif
     }
 
-    // Unmap unprotected granules
-    curr_gran = mem_track[current_realm].gran_type.valid_ns;
-    while (curr_gran != NULL)
+    // RD destroy, undelegate and free
+    ret = val_host_rmi_realm_destroy(mem_track[realm_idx].rd);
+    if (ret)
     {
-        next_gran = curr_gran->next;
-
-        /* Unmap Auxilliary mappings for Unprotected IPA */
-        for (i = 0; i < VAL_MAX_AUX_PLANES; i++)
-        {
-            if (curr_gran->has_auxiliary[i])
-            {
-                cmd_ret = val_host_rmi_rtt_aux_unmap_unprotected(curr_gran->rd,
-                                                             curr_gran->ipa, i + 1);
-                if (cmd_ret.x0)
-                {
-                    LOG(ERROR, "val_rmi_rtt_aux_unmap_unprotected failed, ipa=0x%x, ret=0x%x\n",
-                                                                     curr_gran->ipa, cmd_ret.x0);
-                    return VAL_ERROR;
-                }
-            }
-        }
-
-        ret = val_host_rmi_rtt_unmap_unprotected(curr_gran->rd, curr_gran->ipa,
-                                                       curr_gran->level, &top);
-        if (ret)
-        {
-            LOG(ERROR, "val_rmi_rtt_unmap_unprotected failed, ipa=0x%x, ret=0x%x\n",
-                                                                 curr_gran->ipa, ret);
-            return VAL_ERROR;
-        }
-        curr_gran = next_gran;
-    }
-
-    // Destroy leaf rtt hirerachy
-    if (val_host_destroy_rtt_levels(3, current_realm))
+        LOG(ERROR, "Realm destroy failed, rd=0x%x, ret=0x%x\n", mem_track[realm_idx].rd, ret);
         return VAL_ERROR;
-    if (val_host_destroy_rtt_levels(2, current_realm))
-        return VAL_ERROR;
-    if (val_host_destroy_rtt_levels(1, current_realm))
-        return VAL_ERROR;
-
-#ifdef RMM_V_1_1
-    /* Destroy Auxiliary RTTs */
-    if (val_host_rmm_supports_planes())
-    {
-        for (i = 0; i < VAL_MAX_AUX_PLANES; i++)
-        {
-                if (val_host_destroy_aux_rtt_levels(3, current_realm, i + 1))
-                    return VAL_ERROR;
-                if (val_host_destroy_aux_rtt_levels(2, current_realm, i + 1))
-                    return VAL_ERROR;
-                if (val_host_destroy_aux_rtt_levels(1, current_realm, i + 1))
-                    return VAL_ERROR;
-        }
     }
-#endif
 
-    // RD destroy, undelegate and free
-    ret = val_host_rmi_realm_destroy(mem_track[current_realm].rd);
-    if (ret)
+    /* The realm is gone, but the RTT shadow it was built with was wrong */
+    if (shadow_mismatch)
     {
-        LOG(ERROR, "Realm destroy failed, rd=0x%x, ret=0x%x\n", mem_track[current_realm].rd, ret);
+        LOG(ERROR, "RTT shadow of the realm mismatched RMM, rd=0x%x\n", rd);
         return VAL_ERROR;
     }
 
@@ -2336,24 +4489,32 @@ uint32_t val_host_realm_destroy(uint64_t rd)
 **/
 void val_host_reset_mem_tack(void)
 {
-
-    uint32_t i = 0;
-
-    while (i < VAL_HOST_MAX_REALMS)
-    {
-        /* Reset mem_track.rd to default value */
-        mem_track[i].rd = 0x00000000FFFFFFFF;
-
-        /* Reset mem_track.gran_type.* linked lists */
-        mem_track[i].gran_type.ns = NULL;
-        mem_track[i].gran_type.rd = NULL;
-        mem_track[i].gran_type.rtt = NULL;
-        mem_track[i].gran_type.rec = NULL;
-        mem_track[i].gran_type.data = NULL;
-        mem_track[i].gran_type.valid_ns = NULL;
-
-        i++;
-    }
+    /* Registry slots on the heap are released along with the rest of the heap */
+    mem_track = mem_track_static;
+    realm_index = realm_index_static;
+    mem_track_slots = VAL_HOST_REALM_SLOTS_MIN;
+    mem_track_top = 1;
+    mem_track_free = 0;
+    val_memset(realm_index_static, 0, sizeof(realm_index_static));
+
+    /* Reset the NS mem_track.gran_type.* linked lists */
+    val_memset(&mem_track[0], 0, sizeof(val_host_memory_track_ts));
+    mem_track[0].gran_type.data.ipa_indexed = true;
+    mem_track[0].gran_type.valid_ns.ipa_indexed = true;
+
+    val_memset(granule_map, 0, sizeof(granule_map));
+    teardown_mode = VAL_HOST_TEARDOWN_LISTS;
+    map_mode = VAL_HOST_MAP_PAGES;
+    rtt_shadow_check = false;
+    postamble_mode = VAL_HOST_POSTAMBLE_SERIAL;
+    populate_mode = VAL_HOST_POPULATE_SERIAL;
+    val_init_spinlock(&track_lock);
+
+    /* Node pages and the index are released along with the rest of the heap */
+    track_free_list = NULL;
+    granule_index = NULL;
+    granule_index_slots = 0;
+    granule_index_count = 0;
 }
 
 /**
@@ -2368,37 +4529,30 @@ void val_host_reset_mem_tack(void)
 uint64_t val_host_update_aux_rtt_info(uint64_t gran_state, uint64_t rd,
                                       uint64_t rtt_index, uint64_t ipa, bool val)
 {
+    val_host_granule_ts *current = NULL;
+
+    if (gran_state != GRANULE_DATA && gran_state != GRANULE_UNPROTECTED)
+        return VAL_ERROR;
+
+    val_spin_lock(&track_lock);
+
     /* Get current realm index from rd */
     current_realm = val_host_get_curr_realm(rd);
 
-    val_host_granule_ts *current = NULL;
-
     /* Track the appropriate linked list based on the target granule state */
     if (gran_state == GRANULE_DATA) {
-        current = mem_track[current_realm].gran_type.data;
-    } else if (gran_state == GRANULE_UNPROTECTED) {
-        current = mem_track[current_realm].gran_type.valid_ns;
+        current = val_host_find_ipa_granule(&mem_track[current_realm].gran_type.data, ipa);
     } else {
-        return VAL_ERROR;
+        current = val_host_find_ipa_granule(&mem_track[current_realm].gran_type.valid_ns, ipa);
     }
 
-    /* Linked list cannot be empty*/
-    if (current == NULL)
-        return VAL_ERROR;
-
-    /* Search for the node and update the information */
-    do
-    {
-        if (current->ipa == ipa) {
-            break;
-        } else {
-            current = current->next;
-        }
-    } while (current != NULL);
+    /* Granule must be tracked */
+    if (current != NULL)
+        current->has_auxiliary[rtt_index - 1] = val;
 
-    current->has_auxiliary[rtt_index - 1] = val;
+    val_spin_unlock(&track_lock);
 
-    return VAL_SUCCESS;
+    return (current == NULL) ? VAL_ERROR : VAL_SUCCESS;
 }
 
 /* Checks RMM support for multi plane realms
@@ -8,6 +8,7 @@
 #include "val_host_rmi.h"
 #include "val_libc.h"
 #include "val_host_realm.h"
+#include "val_host_journal.h"
 
 /**
  *   @brief    Returns RMI version
@@ -75,6 +76,7 @@ uint64_t val_host_rmi_data_create(uint64_t rd, uint64_t data,
     uint64_t ret;
 
     ret = (val_smc_call(RMI_DATA_CREATE, rd, data, ipa, src, flags, 0, 0, 0, 0, 0)).x0;
+    val_host_journal_record(RMI_DATA_CREATE, rd, data, ipa, src, flags, ret);
     if (ret)
     {
         return ret;
@@ -97,6 +99,7 @@ uint64_t val_host_rmi_data_create_unknown(uint64_t rd,
     uint64_t ret;
 
     ret = (val_smc_call(RMI_DATA_CREATE_UNKNOWN, rd, data, ipa, 0, 0, 0, 0, 0, 0, 0)).x0;
+    val_host_journal_record(RMI_DATA_CREATE_UNKNOWN, rd, data, ipa, 0, 0, ret);
     if (ret)
     {
         return ret;
@@ -116,6 +119,7 @@ uint64_t val_host_rmi_granule_delegate(uint64_t addr)
     uint64_t ret;
 
     ret = (val_smc_call(RMI_GRANULE_DELEGATE, addr, 0, 0, 0, 0, 0, 0, 0, 0, 0)).x0;
+    val_host_journal_record(RMI_GRANULE_DELEGATE, addr, 0, 0, 0, 0, ret);
     if (ret)
     {
         return ret;
@@ -166,7 +170,12 @@ uint64_t val_host_rmi_psci_complete(uint64_t calling_rec,
 **/
 uint64_t val_host_rmi_realm_activate(uint64_t rd)
 {
-    return (val_smc_call(RMI_REALM_ACTIVATE, rd, 0, 0, 0, 0, 0, 0, 0, 0, 0)).x0;
+    uint64_t ret;
+
+    ret = (val_smc_call(RMI_REALM_ACTIVATE, rd, 0, 0, 0, 0, 0, 0, 0, 0, 0)).x0;
+    val_host_journal_record(RMI_REALM_ACTIVATE, rd, 0, 0, 0, 0, ret);
+
+    return ret;
 }
 
 /**
@@ -180,11 +189,14 @@ uint64_t val_host_rmi_realm_create(uint64_t rd, uint64_t params_ptr)
     uint64_t ret;
 
     ret = (val_smc_call(RMI_REALM_CREATE, rd, params_ptr, 0, 0, 0, 0, 0, 0, 0, 0)).x0;
+    val_host_journal_record(RMI_REALM_CREATE, rd, params_ptr, 0, 0, 0, ret);
     if (ret)
     {
         return ret;
     }
     val_host_update_granule_state(rd, GRANULE_RD, rd, 0, 0, 0);
+    val_host_track_realm_params(rd, ((val_host_realm_params_ts *)params_ptr)->s2sz,
+                                ((val_host_realm_params_ts *)params_ptr)->rtt_level_start);
     return ret;
 }
 
@@ -243,6 +255,7 @@ uint64_t val_host_rmi_rec_create(uint64_t rd, uint64_t rec,
     uint64_t ret;
 
     ret = (val_smc_call(RMI_REC_CREATE, rd, rec, params_ptr, 0, 0, 0, 0, 0, 0, 0)).x0;
+    val_host_journal_record(RMI_REC_CREATE, rd, rec, params_ptr, 0, 0, ret);
     if (ret)
     {
         return ret;
@@ -330,11 +343,15 @@ uint64_t val_host_rmi_rtt_create(uint64_t rd, uint64_t rtt,
     uint64_t ret;
 
     ret = (val_smc_call(RMI_RTT_CREATE, rd, rtt, ipa, level, 0, 0, 0, 0, 0, 0)).x0;
+    val_host_journal_record(RMI_RTT_CREATE, rd, rtt, ipa, level, 0, ret);
     if (ret)
     {
         return ret;
     }
     val_host_update_granule_state(rd, GRANULE_RTT, rtt, ipa, level, 0);
+
+    /* An RTT created over a block splits it */
+    val_host_update_data_map_level(rd, ipa, ipa + val_host_rtt_level_mapsize(level - 1), level);
     return ret;
 }
 
@@ -352,6 +369,7 @@ uint64_t val_host_rmi_rtt_fold(uint64_t rd,
     val_smc_param_ts args;
 
     args = val_smc_call(RMI_RTT_FOLD, rd, ipa, level, 0, 0, 0, 0, 0, 0, 0);
+    val_host_journal_record(RMI_RTT_FOLD, rd, ipa, level, 0, 0, args.x0);
     if (args.x0)
     {
         return args.x0;
@@ -360,6 +378,8 @@ uint64_t val_host_rmi_rtt_fold(uint64_t rd,
     *rtt = args.x1;
 
     val_host_update_destroy_granule_state(rd, 0, ipa, level, GRANULE_DELEGATED, GRANULE_RTT, 0);
+    val_host_update_data_map_level(rd, ipa, ipa + val_host_rtt_level_mapsize(level - 1),
+                                                                              level - 1);
     return args.x0;
 }
 
@@ -403,6 +423,7 @@ uint64_t val_host_rmi_rtt_map_unprotected(uint64_t rd, uint64_t ipa,
     uint64_t ret;
 
     ret = (val_smc_call(RMI_RTT_MAP_UNPROTECTED, rd, ipa, level, desc, 0, 0, 0, 0, 0, 0)).x0;
+    val_host_journal_record(RMI_RTT_MAP_UNPROTECTED, rd, ipa, level, desc, 0, ret);
     if (ret)
     {
         return ret;
@@ -474,6 +495,7 @@ uint64_t val_host_rmi_rtt_init_ripas(uint64_t rd, uint64_t base,
     val_smc_param_ts args;
 
     args = val_smc_call(RMI_RTT_INIT_RIPAS, rd, base, top, 0, 0, 0, 0, 0, 0, 0);
+    val_host_journal_record(RMI_RTT_INIT_RIPAS, rd, base, top, 0, 0, args.x0);
 
     *out_top = args.x1;
     return args.x0;
@@ -514,6 +536,7 @@ val_smc_param_ts val_host_rmi_rtt_aux_create(uint64_t rd, uint64_t rtt,
     val_smc_param_ts args;
 
     args = val_smc_call(RMI_RTT_AUX_CREATE, rd, rtt, ipa, level, index, 0, 0, 0, 0, 0);
+    val_host_journal_record(RMI_RTT_AUX_CREATE, rd, rtt, ipa, level, index, args.x0);
 
     if (args.x0)
         return args;
@@ -584,6 +607,7 @@ val_smc_param_ts val_host_rmi_rtt_aux_map_protected(uint64_t rd, uint64_t ipa, u
     val_smc_param_ts args;
 
     args = val_smc_call(RMI_RTT_AUX_MAP_PROTECTED, rd, ipa, index, 0, 0, 0, 0, 0, 0, 0);
+    val_host_journal_record(RMI_RTT_AUX_MAP_PROTECTED, rd, ipa, index, 0, 0, args.x0);
 
     if (args.x0)
         return args;
@@ -605,6 +629,7 @@ val_smc_param_ts val_host_rmi_rtt_aux_map_unprotected(uint64_t rd, uint64_t ipa,
     val_smc_param_ts args;
 
     args = val_smc_call(RMI_RTT_AUX_MAP_UNPROTECTED, rd, ipa, index, 0, 0, 0, 0, 0, 0, 0);
+    val_host_journal_record(RMI_RTT_AUX_MAP_UNPROTECTED, rd, ipa, index, 0, 0, args.x0);
 
     if (args.x0)
         return args;